@@ -0,0 +1,615 @@
+#include "Benchmark.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "BuildingPulling.h"
+#include "BuildingTable.h"
+#include "CityGenerator.h"
+#include "CityLod.h"
+#include "CityQuadtree.h"
+#include "FrustumCulling.h"
+#include "HeightMap.h"
+#include "HorizonCulling.h"
+#include "IndexedMesh.h"
+#include "OcclusionCulling.h"
+#include "PotentiallyVisibleSet.h"
+#include "VertexFormats.h"
+#include "objectsCoords.h"
+
+
+static double millisecondsSince(std::chrono::high_resolution_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+
+/*
+old roofs search, kept as a reference for the benchmark
+	copies all cubes, then for every pair of cubes on the same (x, z) hides the lower one
+*/
+static void GetRoofsPositions(std::vector <glm::vec4> cubePositions, std::vector <glm::vec4> * roofsPositions)
+{
+	std::vector <glm::vec4> temp;
+	for (unsigned int i = 0; i < cubePositions.size(); i++)//copy all cubes positions and adds 1 to height
+	{
+		temp.push_back(glm::vec4(cubePositions[i].x - 0.5, cubePositions[i].y + 1, cubePositions[i].z - 0.5, cubePositions[i].w));
+	}
+
+	for (unsigned int i = 0; i < temp.size(); i++)
+	{
+		for (unsigned int j = 0; j < temp.size(); j++)
+		{
+			if (temp[i].x == temp[j].x && temp[i].z == temp[j].z && (temp[i].y > temp[j].y))
+			{
+				temp[j].x = -1;
+			}
+		}
+	}
+
+	for (unsigned int i = 0; i < temp.size(); i++)
+	{
+		if (temp[i].x > -1)
+			roofsPositions->push_back(temp[i]);
+	}
+}
+
+
+/*
+ROOFS
+	generate		generateCity, which now also fills the height map
+	old roofs		GetRoofsPositions over the generated cubes (quadratic, measured only up to LEGACY_ROOFS_LIMIT)
+	height map		HeightMap::roofs, the linear replacement
+*/
+static void benchmarkRoofs(unsigned int seed) {
+	const int sizes[] = { 10, 20, 50, 100, 200, 500, 1000, 2000 };
+	const int LEGACY_ROOFS_LIMIT = 200;
+
+	std::cout << std::setw(8) << "size" << std::setw(10) << "cubes" << std::setw(16) << "generate [ms]"
+			  << std::setw(16) << "old roofs [ms]" << std::setw(16) << "height map [ms]" << std::setw(8) << "same" << std::endl;
+	std::cout << std::fixed << std::setprecision(3);
+
+	for (int size : sizes) {
+		std::vector<glm::vec4> cubePositions;
+		HeightMap heightMap;
+
+		srand(seed);
+		auto start = std::chrono::high_resolution_clock::now();
+		generateCity(&cubePositions, &heightMap, size);
+		double generateMs = millisecondsSince(start);
+
+		std::vector<glm::vec4> newRoofs;
+		start = std::chrono::high_resolution_clock::now();
+		heightMap.roofs(&newRoofs);
+		double heightMapMs = millisecondsSince(start);
+
+		std::cout << std::setw(8) << size << std::setw(10) << cubePositions.size() << std::setw(16) << generateMs;
+		if (size <= LEGACY_ROOFS_LIMIT) {
+			std::vector<glm::vec4> oldRoofs;
+			start = std::chrono::high_resolution_clock::now();
+			GetRoofsPositions(cubePositions, &oldRoofs);
+			double oldMs = millisecondsSince(start);
+			std::cout << std::setw(16) << oldMs << std::setw(16) << heightMapMs
+					  << std::setw(8) << (oldRoofs == newRoofs ? "yes" : "NO") << std::endl;
+		}
+		else {
+			std::cout << std::setw(16) << "-" << std::setw(16) << heightMapMs << std::setw(8) << "-" << std::endl;
+		}
+	}
+}
+
+
+/*
+old collision lookup, kept as a reference for the benchmark
+	linear scan over all roofs until the one containing the position is found
+*/
+static float scanRoofs(const std::vector<glm::vec4> & roofsPositions, const glm::vec3 & pos) {
+	float blockSize = 1;
+	for (unsigned int i = 0; i < roofsPositions.size(); i++) {
+		const glm::vec4 & block = roofsPositions[i];
+		if (((block.x + blockSize) > pos.x) && (block.x < pos.x) && ((block.z + blockSize) > pos.z) && (block.z < pos.z))
+			return block.y;
+	}
+	return 0.0f;
+}
+
+
+/*
+COLLISION
+	1 to 1 000 000 random positions per frame over a city of COLLISION_CITY_SIZE
+	old linear scan (only up to LEGACY_SCAN_LIMIT queries), HeightMap::query and HeightMap::queryBatch
+*/
+static void benchmarkCollision(unsigned int seed) {
+	const int COLLISION_CITY_SIZE = 100;
+	const int LEGACY_SCAN_LIMIT = 10000;
+
+	std::vector<glm::vec4> cubePositions;
+	std::vector<glm::vec4> roofsPositions;
+	HeightMap heightMap;
+	srand(seed);
+	generateCity(&cubePositions, &heightMap, COLLISION_CITY_SIZE);
+	heightMap.roofs(&roofsPositions);
+
+	std::cout << "city " << COLLISION_CITY_SIZE << "x" << COLLISION_CITY_SIZE << ", " << roofsPositions.size() << " roofs" << std::endl;
+	std::cout << std::setw(10) << "queries" << std::setw(16) << "scan [ms]" << std::setw(16) << "query [ms]"
+			  << std::setw(16) << "batch [ms]" << std::setw(16) << "batch [ns/q]" << std::endl;
+	std::cout << std::fixed << std::setprecision(3);
+
+	for (int count = 1; count <= 1000000; count *= 10) {
+		std::vector<glm::vec3> positions(count);
+		for (int i = 0; i < count; i++)
+			positions[i] = glm::vec3(COLLISION_CITY_SIZE * (rand() / (float)RAND_MAX), 3.0f,
+									 COLLISION_CITY_SIZE * (rand() / (float)RAND_MAX));
+		std::vector<CellQuery> results(count);
+		float checksum = 0;
+
+		std::cout << std::setw(10) << count;
+		if (count <= LEGACY_SCAN_LIMIT) {
+			auto start = std::chrono::high_resolution_clock::now();
+			for (int i = 0; i < count; i++)
+				checksum += scanRoofs(roofsPositions, positions[i]);
+			std::cout << std::setw(16) << millisecondsSince(start);
+		}
+		else
+			std::cout << std::setw(16) << "-";
+
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < count; i++)
+			checksum += heightMap.query(positions[i]).roofHeight;
+		std::cout << std::setw(16) << millisecondsSince(start);
+
+		start = std::chrono::high_resolution_clock::now();
+		heightMap.queryBatch(positions.data(), count, results.data());
+		double batchMs = millisecondsSince(start);
+		for (int i = 0; i < count; i++)
+			checksum += results[i].roofHeight;
+		std::cout << std::setw(16) << batchMs << std::setw(16) << batchMs * 1.0e6 / count;
+
+		// keeps the compiler from dropping the lookups
+		if (checksum < 0)
+			std::cout << checksum;
+		std::cout << std::endl;
+	}
+}
+
+
+/*
+QUADTREE
+	flat SIMD culling of the whole building table against the quadtree, for a camera in a street
+	(short view along the street) and a camera high above the city looking at its centre
+*/
+static void benchmarkQuadtree(unsigned int seed) {
+	const int REPEATS = 20;
+	std::cout << std::setw(8) << "size" << std::setw(12) << "buildings" << std::setw(10) << "nodes"
+			  << std::setw(8) << "depth" << std::setw(12) << "build ms" << std::setw(8) << "camera"
+			  << std::setw(10) << "visible" << std::setw(12) << "flat ms" << std::setw(12) << "tree ms"
+			  << std::setw(8) << "same" << std::endl;
+	std::cout << std::fixed << std::setprecision(3);
+
+	for (int sizeOfCity = 250; sizeOfCity <= 2000; sizeOfCity *= 2) {
+		std::vector<glm::vec4> cubePositions;
+		HeightMap heightMap;
+		srand(seed);
+		generateCity(&cubePositions, &heightMap, sizeOfCity);
+
+		BuildingTable buildings;
+		buildings.build(cubePositions);
+		CityQuadtree quadtree;
+		auto start = std::chrono::high_resolution_clock::now();
+		quadtree.build(&buildings);
+		double buildMs = millisecondsSince(start);
+
+		// buildings stand on even x and z, half + 1 is a street
+		const float half = (float)(sizeOfCity / 4 * 2);
+		const glm::mat4 projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 100.0f);
+		const glm::mat4 views[2] = {
+			glm::lookAt(glm::vec3(half + 1.0f, 1.5f, half), glm::vec3(half + 1.0f, 1.5f, half + 1.0f), glm::vec3(0, 1, 0)),
+			glm::lookAt(glm::vec3(half, 60.0f, half - 40.0f), glm::vec3(half, 0.0f, half), glm::vec3(0, 1, 0))
+		};
+		const char * cameraNames[2] = { "street", "high" };
+
+		for (int c = 0; c < 2; c++) {
+			Frustum frustum = extractFrustum(projection * views[c]);
+			std::vector<unsigned int> flat, tree;
+
+			start = std::chrono::high_resolution_clock::now();
+			for (int r = 0; r < REPEATS; r++) {
+				flat.clear();
+				cullBuildings(frustum, buildings, &flat);
+			}
+			double flatMs = millisecondsSince(start) / REPEATS;
+
+			start = std::chrono::high_resolution_clock::now();
+			for (int r = 0; r < REPEATS; r++) {
+				tree.clear();
+				quadtree.cullFrustum(frustum, buildings, &tree);
+			}
+			double treeMs = millisecondsSince(start) / REPEATS;
+
+			std::sort(tree.begin(), tree.end());
+			std::cout << std::setw(8) << sizeOfCity << std::setw(12) << buildings.count
+					  << std::setw(10) << quadtree.getNodes().size() << std::setw(8) << quadtree.depth()
+					  << std::setw(12) << buildMs << std::setw(8) << cameraNames[c] << std::setw(10) << flat.size()
+					  << std::setw(12) << flatMs << std::setw(12) << treeMs
+					  << std::setw(8) << (flat == tree ? "yes" : "NO") << std::endl;
+		}
+	}
+}
+
+
+/*
+OCCLUSION
+	quadtree frustum culling followed by the software depth buffer, for cameras in streets and above the city
+	the buffer of the first street camera is written to occlusion.pgm in the temporary directory
+*/
+static void benchmarkOcclusion(unsigned int seed) {
+	const int REPEATS = 20;
+	std::cout << std::setw(8) << "size" << std::setw(10) << "camera" << std::setw(10) << "frustum"
+			  << std::setw(11) << "occluders" << std::setw(10) << "culled" << std::setw(10) << "drawn"
+			  << std::setw(12) << "1 thread" << std::setw(12) << "threads" << std::endl;
+	std::cout << std::fixed << std::setprecision(3);
+
+	for (int sizeOfCity = 250; sizeOfCity <= 1000; sizeOfCity *= 2) {
+		std::vector<glm::vec4> cubePositions;
+		HeightMap heightMap;
+		srand(seed);
+		generateCity(&cubePositions, &heightMap, sizeOfCity);
+		BuildingTable buildings;
+		buildings.build(cubePositions);
+		CityQuadtree quadtree;
+		quadtree.build(&buildings);
+
+		// buildings stand on even x and z, half + 1 is a street
+		const float half = (float)(sizeOfCity / 4 * 2);
+		const glm::mat4 projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 100.0f);
+		const glm::vec3 up(0.0f, 1.0f, 0.0f);
+		const glm::mat4 views[3] = {
+			glm::lookAt(glm::vec3(half + 1.0f, 1.5f, half), glm::vec3(half + 1.0f, 1.5f, half + 1.0f), up),
+			glm::lookAt(glm::vec3(half + 1.0f, 1.5f, half + 1.0f), glm::vec3(half + 2.0f, 1.5f, half + 2.0f), up),
+			glm::lookAt(glm::vec3(half, 60.0f, half - 40.0f), glm::vec3(half, 0.0f, half), up)
+		};
+		const glm::vec3 eyes[3] = {
+			glm::vec3(half + 1.0f, 1.5f, half), glm::vec3(half + 1.0f, 1.5f, half + 1.0f), glm::vec3(half, 60.0f, half - 40.0f)
+		};
+		const char * cameraNames[3] = { "street", "diagonal", "high" };
+
+		for (int c = 0; c < 3; c++) {
+			glm::mat4 viewProjection = projection * views[c];
+			std::vector<unsigned int> frustumVisible;
+			quadtree.cullFrustum(extractFrustum(viewProjection), buildings, &frustumVisible);
+
+			OcclusionCulling occlusion;
+			std::vector<unsigned int> visible;
+			double ms[2];
+			for (int pass = 0; pass < 2; pass++) {
+				occlusion.setThreadCount(pass == 0 ? 1 : 0);
+				auto start = std::chrono::high_resolution_clock::now();
+				for (int r = 0; r < REPEATS; r++) {
+					visible = frustumVisible;
+					occlusion.cull(viewProjection, eyes[c], buildings, &visible);
+				}
+				ms[pass] = millisecondsSince(start) / REPEATS;
+			}
+			if (sizeOfCity == 250 && c == 0)
+				occlusion.dumpDepth(OcclusionCulling::dumpPath().c_str());
+
+			std::cout << std::setw(8) << sizeOfCity << std::setw(10) << cameraNames[c] << std::setw(10) << frustumVisible.size()
+					  << std::setw(11) << occlusion.occluders() << std::setw(10) << occlusion.culled()
+					  << std::setw(10) << visible.size() << std::setw(12) << ms[0] << std::setw(12) << ms[1] << std::endl;
+		}
+	}
+}
+
+
+/*
+HORIZON
+	quadtree frustum culling alone and followed by the horizon pass,
+	with the eye in a street and just over the highest roofs, looking along a street and diagonally
+*/
+static void benchmarkHorizon(unsigned int seed) {
+	const int REPEATS = 20;
+	std::cout << std::setw(8) << "size" << std::setw(8) << "eye y" << std::setw(10) << "camera"
+			  << std::setw(10) << "frustum" << std::setw(10) << "culled" << std::setw(10) << "drawn"
+			  << std::setw(12) << "frustum ms" << std::setw(12) << "horizon ms" << std::endl;
+	std::cout << std::fixed << std::setprecision(3);
+
+	for (int sizeOfCity = 250; sizeOfCity <= 1000; sizeOfCity *= 2) {
+		std::vector<glm::vec4> cubePositions;
+		HeightMap heightMap;
+		srand(seed);
+		generateCity(&cubePositions, &heightMap, sizeOfCity);
+		BuildingTable buildings;
+		buildings.build(cubePositions);
+		CityQuadtree quadtree;
+		quadtree.build(&buildings);
+
+		// buildings stand on even x and z, half + 1 is a street; roofs are 2 - 5 floors high
+		const float half = (float)(sizeOfCity / 4 * 2);
+		const glm::mat4 projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 100.0f);
+		const float eyeHeights[2] = { 1.5f, 5.5f };
+		const glm::vec3 directions[2] = { glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(1.0f, 0.0f, 1.0f) };
+		const char * cameraNames[2] = { "street", "diagonal" };
+
+		for (int h = 0; h < 2; h++) {
+			for (int c = 0; c < 2; c++) {
+				glm::vec3 eye(half + 1.0f, eyeHeights[h], half + 1.0f);
+				Frustum frustum = extractFrustum(projection * glm::lookAt(eye, eye + directions[c], glm::vec3(0.0f, 1.0f, 0.0f)));
+
+				std::vector<unsigned int> frustumVisible, visible;
+				auto start = std::chrono::high_resolution_clock::now();
+				for (int r = 0; r < REPEATS; r++) {
+					frustumVisible.clear();
+					quadtree.cullFrustum(frustum, buildings, &frustumVisible);
+				}
+				double frustumMs = millisecondsSince(start) / REPEATS;
+
+				HorizonCulling horizon;
+				start = std::chrono::high_resolution_clock::now();
+				for (int r = 0; r < REPEATS; r++) {
+					visible = frustumVisible;
+					horizon.cull(eye, buildings, &visible);
+				}
+				double horizonMs = millisecondsSince(start) / REPEATS;
+
+				std::cout << std::setw(8) << sizeOfCity << std::setw(8) << eyeHeights[h] << std::setw(10) << cameraNames[c]
+						  << std::setw(10) << frustumVisible.size() << std::setw(10) << horizon.culled()
+						  << std::setw(10) << visible.size() << std::setw(12) << frustumMs << std::setw(12) << horizonMs << std::endl;
+			}
+		}
+	}
+}
+
+
+/*
+PVS
+	build of the potentially visible sets (all hardware threads), their size and the cost of a lookup
+*/
+static void benchmarkPvs(unsigned int seed) {
+	const float VIEW_DISTANCE = farCornerDistance(glm::radians(45.0f), 800.0f / 600.0f, 100.0f);
+	const int LOOKUPS = 10000;
+	std::cout << std::setw(8) << "size" << std::setw(12) << "buildings" << std::setw(8) << "cells"
+			  << std::setw(12) << "build ms" << std::setw(12) << "avg visible" << std::setw(12) << "max visible"
+			  << std::setw(12) << "PVS KB" << std::setw(12) << "bitset KB" << std::setw(12) << "lookup us" << std::endl;
+	std::cout << std::fixed << std::setprecision(3);
+
+	for (int sizeOfCity = 20; sizeOfCity <= 80; sizeOfCity *= 2) {
+		std::vector<glm::vec4> cubePositions;
+		HeightMap heightMap;
+		srand(seed);
+		generateCity(&cubePositions, &heightMap, sizeOfCity);
+		BuildingTable buildings;
+		buildings.build(cubePositions);
+		CityQuadtree quadtree;
+		quadtree.build(&buildings);
+
+		PotentiallyVisibleSet pvs;
+		pvs.build(heightMap, buildings, quadtree, VIEW_DISTANCE);
+
+		// eyes on random street cells (odd x)
+		std::vector<unsigned int> visible;
+		size_t checksum = 0;
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < LOOKUPS; i++) {
+			glm::vec3 eye((float)(rand() % (sizeOfCity / 2) * 2 + 1), 0.3f, (float)(rand() % sizeOfCity));
+			visible.clear();
+			pvs.visibleFrom(eye, &visible);
+			checksum += visible.size();
+		}
+		double lookupUs = millisecondsSince(start) * 1000.0 / LOOKUPS;
+
+		std::cout << std::setw(8) << sizeOfCity << std::setw(12) << buildings.count << std::setw(8) << pvs.streetCells()
+				  << std::setw(12) << pvs.buildMilliseconds() << std::setw(12) << pvs.averageVisible()
+				  << std::setw(12) << pvs.maximumVisible() << std::setw(12) << pvs.memoryBytes() / 1024.0
+				  << std::setw(12) << pvs.uncompressedBytes() / 1024.0 << std::setw(12) << lookupUs;
+		if (checksum == 0)
+			std::cout << " (no set found)";
+		std::cout << std::endl;
+	}
+}
+
+
+/*
+HLOD
+	camera above the street looking over the city from farther and farther away: triangles and draw calls
+	of full detail (one draw per cube face) against CityLod proxies, and the time of choosing the level
+*/
+static void benchmarkHlod(unsigned int seed) {
+	const int REPEATS = 20;
+	const int sizeOfCity = 250;
+	std::vector<glm::vec4> cubePositions;
+	HeightMap heightMap;
+	srand(seed);
+	generateCity(&cubePositions, &heightMap, sizeOfCity);
+	BuildingTable buildings;
+	buildings.build(cubePositions);
+	CityQuadtree quadtree;
+	quadtree.build(&buildings);
+	CityLod lod;
+	lod.build(buildings, quadtree, cubePositions);
+	lod.setProjection(glm::radians(45.0f), 600.0f);
+
+	std::cout << std::setw(10) << "distance" << std::setw(10) << "visible" << std::setw(8) << "blocks"
+			  << std::setw(8) << "proxies" << std::setw(12) << "full tris" << std::setw(12) << "hlod tris"
+			  << std::setw(12) << "full draws" << std::setw(12) << "hlod draws" << std::setw(12) << "select ms" << std::endl;
+	std::cout << std::fixed << std::setprecision(3);
+
+	const glm::mat4 projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 100.0f);
+	const float half = (float)(sizeOfCity / 4 * 2);
+	const float distances[6] = { 0.0f, 10.0f, 25.0f, 50.0f, 75.0f, 90.0f };
+	for (int d = 0; d < 6; d++) {
+		// from the street at the edge of the city backwards, looking along the streets
+		glm::vec3 eye(half + 1.0f, 8.0f, -distances[d] - 1.0f);
+		Frustum frustum = extractFrustum(projection * glm::lookAt(eye, eye + glm::vec3(0.0f, -0.1f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+		std::vector<unsigned int> visible;
+		quadtree.cullFrustum(frustum, buildings, &visible);
+
+		unsigned int blocks = 0, fullTriangles = 0, lodTriangles = 0, fullDraws = 0, lodDraws = 0;
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int r = 0; r < REPEATS; r++) {
+			lod.resetStats();
+			blocks = fullTriangles = lodTriangles = fullDraws = lodDraws = 0;
+			bool blockProxy = false;
+			unsigned int lastBlock = 0;
+			for (size_t b = 0; b < visible.size(); b++) {
+				unsigned int block = quadtree.leafOf(visible[b]);
+				if (b == 0 || block != lastBlock) {
+					lastBlock = block;
+					blocks++;
+					blockProxy = lod.useProxy(block, eye);
+					if (blockProxy) {
+						lodTriangles += lod.proxyTriangles(block);
+						lodDraws++;
+					}
+				}
+				unsigned int cubes = buildings.cubeCount[visible[b]];
+				fullTriangles += cubes * CityLod::CUBE_TRIANGLES;
+				fullDraws += cubes * 6;
+				if (!blockProxy) {
+					lodTriangles += cubes * CityLod::CUBE_TRIANGLES;
+					lodDraws += cubes * 6;
+				}
+			}
+		}
+		double selectMs = millisecondsSince(start) / REPEATS;
+
+		std::cout << std::setw(10) << distances[d] << std::setw(10) << visible.size() << std::setw(8) << blocks
+				  << std::setw(8) << lod.proxyBlocks() << std::setw(12) << fullTriangles << std::setw(12) << lodTriangles
+				  << std::setw(12) << fullDraws << std::setw(12) << lodDraws << std::setw(12) << selectMs << std::endl;
+	}
+}
+
+
+/*
+VERTEX FORMATS
+	vertex bytes read by the GPU in a frame that draws every cube of the city with the indexed cube mesh:
+	cubes * triangles * ACMR (vertices fetched per triangle) * bytes of a vertex, the first row of a size
+	is the triangle list of objectsCoords.cpp (36 float vertices per cube, no cache)
+*/
+static void benchmarkVertexFormats(unsigned int seed) {
+	const int REPEATS = 1000;
+	IndexedMesh cubeMesh;
+	MeshStats stats;
+	buildIndexedMesh(verticesTab3, verticesSize3 / (8 * sizeof(float)), 8, std::vector<unsigned int>(verticesSize3 / (8 * sizeof(float)) / 6, 2), &cubeMesh, &stats);
+	const float triangles = (float)cubeMesh.indices.size() / 3;
+
+	std::cout << std::setw(8) << "size" << std::setw(10) << "cubes" << std::setw(12) << "format" << std::setw(8) << "bytes"
+			  << std::setw(12) << "mesh bytes" << std::setw(14) << "MB per frame" << std::setw(14) << "GB/s at 60"
+			  << std::setw(12) << "pack us" << std::setw(12) << "max error" << std::endl;
+	std::cout << std::fixed << std::setprecision(3);
+
+	for (int sizeOfCity = 250; sizeOfCity <= 1000; sizeOfCity *= 2) {
+		std::vector<glm::vec4> cubePositions;
+		HeightMap heightMap;
+		srand(seed);
+		generateCity(&cubePositions, &heightMap, sizeOfCity);
+		const double cubes = (double)cubePositions.size();
+
+		double listBytes = cubes * verticesSize3;
+		std::cout << std::setw(8) << sizeOfCity << std::setw(10) << cubePositions.size() << std::setw(12) << "list"
+				  << std::setw(8) << 8 * sizeof(float) << std::setw(12) << verticesSize3 << std::setw(14) << listBytes / 1e6
+				  << std::setw(14) << listBytes * 60.0 / 1e9 << std::setw(12) << "-" << std::setw(12) << "-" << std::endl;
+
+		for (int f = 0; f < VERTEX_FORMAT_COUNT; f++) {
+			const VertexFormat & format = getVertexFormat((Vertex_Format)f);
+			PackedMesh packed;
+			float maxError = 0.0f;
+			auto start = std::chrono::high_resolution_clock::now();
+			for (int r = 0; r < REPEATS; r++)
+				packMesh(cubeMesh, (Vertex_Format)f, &packed, &maxError);
+			double packUs = millisecondsSince(start) * 1000.0 / REPEATS;
+
+			double frameBytes = cubes * triangles * stats.acmrOptimized * format.stride;
+			std::cout << std::setw(8) << sizeOfCity << std::setw(10) << cubePositions.size() << std::setw(12) << format.name
+					  << std::setw(8) << format.stride << std::setw(12) << packed.vertices.size() + packed.indices.size() * sizeof(unsigned int)
+					  << std::setw(14) << frameBytes / 1e6 << std::setw(14) << frameBytes * 60.0 / 1e9
+					  << std::setw(12) << packUs << std::setw(12) << maxError << std::endl;
+		}
+	}
+}
+
+
+/*
+PULLING
+	a frame that draws the whole city by floors (packed16 cube mesh, a model matrix and 6 draws per cube)
+	against BuildingPulling (one record per building, 12 draws): bytes sent and read per frame
+	and the CPU time of preparing them (matrices / records), the GPU time is in the frame stats ('B' key)
+*/
+static void benchmarkPulling(unsigned int seed) {
+	const int REPEATS = 10;
+	IndexedMesh cubeMesh;
+	MeshStats stats;
+	buildIndexedMesh(verticesTab3, verticesSize3 / (8 * sizeof(float)), 8, std::vector<unsigned int>(verticesSize3 / (8 * sizeof(float)) / 6, 2), &cubeMesh, &stats);
+	const GLsizei stride = getVertexFormat(VERTEX_PACKED16).stride;
+	const double cubeFetch = cubeMesh.indices.size() / 3 * stats.acmrOptimized * stride;
+
+	std::cout << std::setw(8) << "size" << std::setw(10) << "buildings" << std::setw(10) << "cubes"
+			  << std::setw(12) << "floors MB" << std::setw(12) << "floor draws" << std::setw(12) << "floors ms"
+			  << std::setw(12) << "pulled MB" << std::setw(12) << "pull draws" << std::setw(12) << "pulled ms" << std::endl;
+	std::cout << std::fixed << std::setprecision(3);
+
+	for (int sizeOfCity = 250; sizeOfCity <= 1000; sizeOfCity *= 2) {
+		std::vector<glm::vec4> cubePositions;
+		HeightMap heightMap;
+		srand(seed);
+		generateCity(&cubePositions, &heightMap, sizeOfCity);
+		BuildingTable buildings;
+		buildings.build(cubePositions);
+
+		// by floors: the vertices of the cube are read again for every floor, a matrix is sent for every floor
+		std::vector<glm::mat4> models(cubePositions.size());
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int r = 0; r < REPEATS; r++)
+			for (size_t i = 0; i < cubePositions.size(); i++)
+				models[i] = glm::translate(glm::mat4(), glm::vec3(cubePositions[i]));
+		double floorsMs = millisecondsSince(start) / REPEATS;
+		double floorsBytes = cubePositions.size() * (cubeFetch + sizeof(glm::mat4));
+
+		BuildingPulling pulling;
+		start = std::chrono::high_resolution_clock::now();
+		for (int r = 0; r < REPEATS; r++) {
+			pulling.clear();
+			for (unsigned int b = 0; b < buildings.count; b++)
+				pulling.add(b, buildings, cubePositions);
+		}
+		double pulledMs = millisecondsSince(start) / REPEATS;
+		double pulledBytes = (double)buildings.count * sizeof(uint32_t);
+
+		std::cout << std::setw(8) << sizeOfCity << std::setw(10) << buildings.count << std::setw(10) << cubePositions.size()
+				  << std::setw(12) << floorsBytes / 1e6 << std::setw(12) << cubePositions.size() * 6 << std::setw(12) << floorsMs
+				  << std::setw(12) << pulledBytes / 1e6 << std::setw(12) << BuildingPulling::LEVELS * 3 << std::setw(12) << pulledMs << std::endl;
+	}
+}
+
+
+bool runBenchmark(const char * name, unsigned int seed) {
+	if (strcmp(name, "roofs") == 0)
+		benchmarkRoofs(seed);
+	else if (strcmp(name, "collision") == 0)
+		benchmarkCollision(seed);
+	else if (strcmp(name, "quadtree") == 0)
+		benchmarkQuadtree(seed);
+	else if (strcmp(name, "occlusion") == 0)
+		benchmarkOcclusion(seed);
+	else if (strcmp(name, "horizon") == 0)
+		benchmarkHorizon(seed);
+	else if (strcmp(name, "pvs") == 0)
+		benchmarkPvs(seed);
+	else if (strcmp(name, "hlod") == 0)
+		benchmarkHlod(seed);
+	else if (strcmp(name, "vertexformats") == 0)
+		benchmarkVertexFormats(seed);
+	else if (strcmp(name, "pulling") == 0)
+		benchmarkPulling(seed);
+	else {
+		std::cout << "Unknown benchmark: " << name << std::endl;
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,21 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+/*
+BENCHMARKS
+	CPU-only measurements started with "--bench NAME", they don't open a window
+	and print one row per city size to the console
+
+	roofs		GetRoofsPositions (old O(n^2) pass) against HeightMap filled by generateCity
+	collision	linear scan of roofs against HeightMap::query / queryBatch, 1 to 1 000 000 queries per frame
+	quadtree	flat SIMD frustum culling of all buildings against CityQuadtree::cullFrustum
+	occlusion	buildings left after frustum culling against the software depth buffer (writes occlusion.pgm to the temporary directory)
+	horizon		frustum culling alone and followed by HorizonCulling, at street and at roof level
+	pvs			build time, memory and lookup time of PotentiallyVisibleSet
+	hlod		triangles and draw calls of full detail against CityLod proxies at growing camera distance
+	vertexformats	vertex bytes fetched per frame by the float and packed VertexFormats on big cities
+	pulling		bytes per frame and CPU preparation of buildings drawn by floors against BuildingPulling
+*/
+bool runBenchmark(const char * name, unsigned int seed);
+
+#endif
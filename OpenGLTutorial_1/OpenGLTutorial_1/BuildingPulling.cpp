@@ -0,0 +1,131 @@
+#include "BuildingPulling.h"
+
+#include <algorithm>
+
+
+BuildingPulling::BuildingPulling()
+	: VAO(0), buffer(0), texture(0)
+{
+	clear();
+}
+
+
+// core profile draws only with a VAO bound, even one without attributes
+void BuildingPulling::create()
+{
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &buffer);
+	glGenTextures(1, &texture);
+	glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+	glBufferData(GL_TEXTURE_BUFFER, sizeof(uint32_t), NULL, GL_STREAM_DRAW);
+	glBindTexture(GL_TEXTURE_BUFFER, texture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, buffer);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void BuildingPulling::release()
+{
+	if (VAO != 0) {
+		glDeleteTextures(1, &texture);
+		glDeleteBuffers(1, &buffer);
+		glDeleteVertexArrays(1, &VAO);
+	}
+	VAO = buffer = texture = 0;
+}
+
+
+/*
+RECORD
+	bits 0 - 11 x, 12 - 23 z, 24 - 29 floors, 30 - 31 level (unpacked the same way by building_pulling.vs)
+*/
+uint32_t BuildingPulling::packBuilding(unsigned int x, unsigned int z, unsigned int floors, unsigned int level)
+{
+	return (x & 0xfff) | (z & 0xfff) << 12 | (std::min(floors, MAX_FLOORS - 1) & 0x3f) << 24 | (level & 0x3) << 30;
+}
+
+void BuildingPulling::unpackBuilding(uint32_t record, unsigned int * x, unsigned int * z, unsigned int * floors, unsigned int * level)
+{
+	*x = record & 0xfff;
+	*z = (record >> 12) & 0xfff;
+	*floors = (record >> 24) & 0x3f;
+	*level = record >> 30;
+}
+
+uint32_t BuildingPulling::recordOf(unsigned int building, const BuildingTable & buildings, const std::vector<glm::vec4> & cubePositions)
+{
+	unsigned int level = (unsigned int)cubePositions[buildings.firstCube[building]].w & 0x3;
+	return packBuilding((unsigned int)buildings.centerX[building], (unsigned int)buildings.centerZ[building],
+						buildings.cubeCount[building], level);
+}
+
+
+void BuildingPulling::clear()
+{
+	for (int level = 0; level < LEVELS; level++)
+		for (int bucket = 0; bucket < BUCKETS; bucket++)
+			buckets[level][bucket].clear();
+	groups.clear();
+	beginGroup(0);
+}
+
+// the last group is reused when nothing was added to it, so there are no empty groups to draw
+void BuildingPulling::beginGroup(unsigned int id)
+{
+	if (groups.empty() || !isGroupEmpty(groups.back()))
+		groups.push_back(Group());
+	Group & group = groups.back();
+	group.id = id;
+	for (int level = 0; level < LEVELS; level++)
+		for (int bucket = 0; bucket < BUCKETS; bucket++) {
+			group.start[level][bucket] = buckets[level][bucket].size();
+			group.first[level][bucket] = 0;
+			group.count[level][bucket] = 0;
+		}
+}
+
+bool BuildingPulling::isGroupEmpty(const Group & group) const
+{
+	for (int level = 0; level < LEVELS; level++)
+		for (int bucket = 0; bucket < BUCKETS; bucket++)
+			if (group.start[level][bucket] != buckets[level][bucket].size())
+				return false;
+	return true;
+}
+
+void BuildingPulling::add(unsigned int building, const BuildingTable & buildings, const std::vector<glm::vec4> & cubePositions,
+						  unsigned int faces)
+{
+	uint32_t record = recordOf(building, buildings, cubePositions);
+	std::vector<uint32_t> * levelBuckets = buckets[record >> 30];
+	if (faces == ALL_FACES) {
+		levelBuckets[WHOLE_BOXES].push_back(record);
+		return;
+	}
+	for (int face = 0; face < FACE_COUNT; face++)
+		if (faces & (1u << face))
+			levelBuckets[face].push_back(record);
+}
+
+
+void BuildingPulling::upload()
+{
+	records.clear();
+	for (size_t g = 0; g < groups.size(); g++) {
+		Group & group = groups[g];
+		for (int level = 0; level < LEVELS; level++)
+			for (int bucket = 0; bucket < BUCKETS; bucket++) {
+				const std::vector<uint32_t> & source = buckets[level][bucket];
+				size_t end = g + 1 < groups.size() ? groups[g + 1].start[level][bucket] : source.size();
+				group.first[level][bucket] = (GLint)records.size();
+				group.count[level][bucket] = (GLsizei)(end - group.start[level][bucket]);
+				records.insert(records.end(), source.begin() + group.start[level][bucket], source.begin() + end);
+			}
+	}
+	if (records.empty())
+		return;
+	glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+	glBufferData(GL_TEXTURE_BUFFER, records.size() * sizeof(uint32_t), NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_TEXTURE_BUFFER, 0, records.size() * sizeof(uint32_t), records.data());
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
@@ -0,0 +1,89 @@
+#ifndef BUILDING_PULLING_H
+#define BUILDING_PULLING_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <stdint.h>
+#include <vector>
+
+#include "BuildingTable.h"
+#include "FaceDirections.h"
+
+/*
+BUILDING PULLING
+	programmable vertex pulling of whole buildings: the only data of a drawn building is one 32-bit record
+	(x and z cell 12 bits each, floors 6 bits, texture level 2 bits) in a texture buffer, building_pulling.vs
+	reads it with texelFetch(gl_InstanceID) and takes the corner, normal and texture coords of the box from
+	gl_VertexID, there is no vertex buffer and no model matrix, a building is one box instead of a cube per floor
+	records of a frame are grouped by level, a level is drawn with 3 instanced draws (one per texture,
+	gl_VertexID <0, 12) front + back, <12, 24) left + right, <24, 36) bottom + top, the order of verticesTab3)
+	GL 3.3 has no base instance, the first record of the level is the firstBuilding uniform
+	a building added with only the faces turned to the eye goes to the direction buckets of those faces
+	instead (at most 3 of 6, drawn with one instanced draw of 6 vertices per face), so back faces
+	are not sent to the vertex shader at all
+	beginGroup splits the records of a frame into groups (city blocks), each with its own levels and buckets,
+	so a group can be drawn on its own (inside the conditional render of its block), without it a frame is one group
+*/
+class BuildingPulling
+{
+public:
+	static const int LEVELS = 4;
+	static const int FACE_VERTICES = 12;	// two faces with the same texture
+	static const int SIDE_VERTICES = 6;		// one face of a direction bucket
+	// records of a level: a bucket per Face_Direction, then the one of whole boxes
+	static const int BUCKETS = FACE_COUNT + 1;
+	static const int WHOLE_BOXES = FACE_COUNT;
+	static const unsigned int MAX_CELL = 4096;
+	static const unsigned int MAX_FLOORS = 64;
+
+	BuildingPulling();
+
+	// texture buffer and the empty VAO (needs the GL context)
+	void create();
+	void release();
+
+	// records fit cities up to MAX_CELL cells and MAX_FLOORS floors
+	static bool canPull(int sizeOfCity) { return sizeOfCity > 0 && (unsigned int)sizeOfCity <= MAX_CELL; }
+	static uint32_t packBuilding(unsigned int x, unsigned int z, unsigned int floors, unsigned int level);
+	static void unpackBuilding(uint32_t record, unsigned int * x, unsigned int * z, unsigned int * floors, unsigned int * level);
+	// record of a building of the table, its level is the one of its first floor
+	static uint32_t recordOf(unsigned int building, const BuildingTable & buildings, const std::vector<glm::vec4> & cubePositions);
+
+	// start of a frame, building added for this frame
+	void clear();
+	// buildings added from now on go to a new group, id - the caller's name of it (city block)
+	void beginGroup(unsigned int id);
+	// faces - mask of facesTowardEye, ALL_FACES - the whole box
+	void add(unsigned int building, const BuildingTable & buildings, const std::vector<glm::vec4> & cubePositions,
+			 unsigned int faces = ALL_FACES);
+
+	// records of the frame to the texture buffer, one copy per frame (the old storage is orphaned)
+	void upload();
+
+	GLuint getVAO() const { return VAO; }
+	GLuint getTexture() const { return texture; }
+	// groups of the frame and records of their buckets after upload
+	size_t groupCount() const { return groups.size(); }
+	unsigned int groupId(size_t group) const { return groups[group].id; }
+	GLint firstBuilding(size_t group, int level, int bucket) const { return groups[group].first[level][bucket]; }
+	GLsizei buildingCount(size_t group, int level, int bucket) const { return groups[group].count[level][bucket]; }
+	size_t uploadedBytes() const { return records.size() * sizeof(uint32_t); }
+
+private:
+	struct Group {
+		unsigned int id;
+		size_t start[LEVELS][BUCKETS];	// first record of the group in buckets
+		GLint first[LEVELS][BUCKETS];	// in records, set by upload
+		GLsizei count[LEVELS][BUCKETS];
+	};
+
+	bool isGroupEmpty(const Group & group) const;
+
+	std::vector<uint32_t> buckets[LEVELS][BUCKETS];
+	std::vector<Group> groups;
+	std::vector<uint32_t> records;		// buckets of levels of groups one after another, as uploaded
+	GLuint VAO, buffer, texture;
+};
+
+#endif
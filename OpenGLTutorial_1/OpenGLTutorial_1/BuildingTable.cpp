@@ -0,0 +1,59 @@
+#include "BuildingTable.h"
+
+
+void BuildingTable::build(const std::vector<glm::vec4> & cubePositions)
+{
+	centerX.clear(); centerY.clear(); centerZ.clear();
+	extentX.clear(); extentY.clear(); extentZ.clear();
+	firstCube.clear();
+	cubeCount.clear();
+
+	size_t first = 0;
+	while (first < cubePositions.size()) {
+		size_t last = first + 1;
+		while (last < cubePositions.size() && cubePositions[last].x == cubePositions[first].x &&
+			   cubePositions[last].z == cubePositions[first].z)
+			last++;
+
+		// cube i is centred on (x, y, z) and spans +-0.5 on every axis
+		float bottom = cubePositions[first].y - 0.5f;
+		float top = cubePositions[last - 1].y + 0.5f;
+		centerX.push_back(cubePositions[first].x);
+		centerY.push_back((bottom + top) * 0.5f);
+		centerZ.push_back(cubePositions[first].z);
+		extentX.push_back(0.5f);
+		extentY.push_back((top - bottom) * 0.5f);
+		extentZ.push_back(0.5f);
+		firstCube.push_back((unsigned int)first);
+		cubeCount.push_back((unsigned int)(last - first));
+
+		first = last;
+	}
+	count = firstCube.size();
+
+	// padding: negative extents put the box behind every plane
+	while (centerX.size() % BUILDING_TABLE_PADDING != 0) {
+		centerX.push_back(0.0f); centerY.push_back(0.0f); centerZ.push_back(0.0f);
+		extentX.push_back(-1.0e30f); extentY.push_back(-1.0e30f); extentZ.push_back(-1.0e30f);
+		firstCube.push_back(0);
+		cubeCount.push_back(0);
+	}
+}
+
+
+template <typename T>
+static void permute(std::vector<T> * values, const std::vector<unsigned int> & order)
+{
+	std::vector<T> sorted(*values);
+	for (size_t i = 0; i < order.size(); i++)
+		sorted[i] = (*values)[order[i]];
+	values->swap(sorted);
+}
+
+void BuildingTable::reorder(const std::vector<unsigned int> & order)
+{
+	permute(&centerX, order); permute(&centerY, order); permute(&centerZ, order);
+	permute(&extentX, order); permute(&extentY, order); permute(&extentZ, order);
+	permute(&firstCube, order);
+	permute(&cubeCount, order);
+}
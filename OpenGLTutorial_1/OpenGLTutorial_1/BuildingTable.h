@@ -0,0 +1,38 @@
+#ifndef BUILDING_TABLE_H
+#define BUILDING_TABLE_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/*
+BUILDING TABLE
+	one axis-aligned box per building (column of cubes with the same x, z) in structure-of-arrays layout,
+	so culling can test several buildings with one SIMD instruction
+	arrays are padded to BUILDING_TABLE_PADDING with boxes that are never visible
+*/
+const size_t BUILDING_TABLE_PADDING = 8;
+
+struct BuildingTable {
+	// box of the building: center +- extent
+	std::vector<float> centerX, centerY, centerZ;
+	std::vector<float> extentX, extentY, extentZ;
+	// floors of the building in cubePositions: <firstCube, firstCube + cubeCount)
+	std::vector<unsigned int> firstCube;
+	std::vector<unsigned int> cubeCount;
+	size_t count;			// number of real buildings, arrays can be longer
+
+	BuildingTable() : count(0) {}
+
+	// group consecutive cubes standing on the same cell (generateCity creates them that way)
+	void build(const std::vector<glm::vec4> & cubePositions);
+
+	// new building i is the old building order[i], padding stays at the end
+	void reorder(const std::vector<unsigned int> & order);
+
+	size_t paddedCount() const { return centerX.size(); }
+	glm::vec3 center(size_t i) const { return glm::vec3(centerX[i], centerY[i], centerZ[i]); }
+	glm::vec3 extent(size_t i) const { return glm::vec3(extentX[i], extentY[i], extentZ[i]); }
+};
+
+#endif
@@ -55,7 +55,7 @@ public:
 	float nearestRoofYPosition;
 	const float characterHeight = 0.1;
 	const float cameraDistance = 0.2;
-	const int sizeOfCity = 20;
+	int sizeOfCity = 20;
 
 	void SetUpCharacterMovementParameters() 
 	{
@@ -130,6 +130,12 @@ public:
 		return glm::lookAt(Position, Position + Front, Up);
 	}
 
+	// View matrix from another eye position (e.g. interpolated between two simulation steps)
+	glm::mat4 GetViewMatrix(const glm::vec3 & eye)
+	{
+		return glm::lookAt(eye, eye + Front, Up);
+	}
+
 	// Processes input received from any keyboard-like input system. Accepts input parameter in the form of camera defined ENUM (to abstract it from windowing systems)
 	void ProcessKeyboard(Camera_Movement direction, float deltaTime)
 	{
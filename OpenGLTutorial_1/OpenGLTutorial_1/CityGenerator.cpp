@@ -0,0 +1,100 @@
+#include "CityGenerator.h"
+
+#include <cstdlib>
+
+
+/*
+generate cubes
+	choose position on Z-axis, X-axis on area
+	take random number as height of the building (Y-axis)
+	create cube and pass it on to the vector of vec3
+	write height and texture of the building to the height map
+*/
+void generateCity(std::vector<glm::vec4>* cubePositions, HeightMap* heightMap, int sizeOfCity) {
+	heightMap->reset(sizeOfCity, sizeOfCity);
+	for (int k = 0; k < sizeOfCity; k++) { // z
+		if (k % 2 == 0) {
+			for (int j = 0; j < sizeOfCity; j++) {  // x
+				if (j % 2 == 0) {
+					int height = 4;
+					int lowest = 2;
+					int buildingHeight = std::rand() % height + lowest; // <lowest, lowest+height>
+					float texture = 0.0f;
+						if (buildingHeight % height == 1) {
+							texture = 1.0f;
+						}
+						else if (buildingHeight % height == 2) {
+							texture = 2.0f;
+						}
+						else if (buildingHeight % height == 3) {
+							texture = 3.0f;
+						}
+						else {
+							texture = 0.0f;
+						}
+					for (int i = 0; i < buildingHeight; i++) {  // y
+						cubePositions->push_back(glm::vec4((float)j, (float)i, (float)k, texture));
+					}
+					heightMap->setColumn(j, k, buildingHeight, (int)texture);
+				}
+			}
+		}
+	}
+}
+
+
+/*
+generate flat street crossings
+	choose position on Z-axis, X-axis on area
+	Y-axis always 0 (ground level)
+	create square and pass it on to the vector of vec3
+*/
+void generateCrossings(std::vector<glm::vec3>* streetPositions, int sizeOfCity) {
+	for (int k = 0; k < sizeOfCity; k++) { // z
+		if (k % 2 != 0) {
+			for (int j = 0; j < sizeOfCity; j++) {  // x
+				if (j % 2 != 0) {
+						streetPositions->push_back(glm::vec3((float)j, 0.0f, (float)k));
+				}
+			}
+		}
+	}
+}
+
+
+/*
+generate flat street 
+choose position on Z-axis, X-axis on area
+Y-axis always 0 (ground level)
+create square and pass it on to the vector of vec3
+*/
+void generateStreet(std::vector<glm::vec3>* streetPositions, int sizeOfCity) {
+	for (int k = 0; k < sizeOfCity; k++) { // z
+		if (k % 2 == 0) {
+			for (int j = 0; j < sizeOfCity; j++) {  // x
+				if (j % 2 != 0) {
+					streetPositions->push_back(glm::vec3((float)j, 0.0f, (float)k));
+				}
+			}
+		}
+	}
+}
+
+
+/*
+generate flat street
+choose position on Z-axis, X-axis on area
+Y-axis always 0 (ground level)
+create square and pass it on to the vector of vec3
+*/
+void generateStreet2(std::vector<glm::vec3>* streetPositions, int sizeOfCity) {
+	for (int k = 0; k < sizeOfCity; k++) { // z
+		if (k % 2 != 0) {
+			for (int j = 0; j < sizeOfCity; j++) {  // x
+				if (j % 2 == 0) {
+					streetPositions->push_back(glm::vec3((float)j, 0.0f, (float)k));
+				}
+			}
+		}
+	}
+}
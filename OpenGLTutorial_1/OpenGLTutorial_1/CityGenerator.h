@@ -0,0 +1,16 @@
+#ifndef CITY_GENERATOR_H
+#define CITY_GENERATOR_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "HeightMap.h"
+
+// buildings stand on cells with even x and z, streets and crossings fill the rest of the grid
+void generateCity(std::vector<glm::vec4>* cubePositions, HeightMap* heightMap, int sizeOfCity);
+void generateCrossings(std::vector<glm::vec3>* streetPositions, int sizeOfCity);
+void generateStreet(std::vector<glm::vec3>* streetPositions, int sizeOfCity);
+void generateStreet2(std::vector<glm::vec3>* streetPositions, int sizeOfCity);
+
+#endif
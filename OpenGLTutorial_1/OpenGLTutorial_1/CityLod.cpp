@@ -0,0 +1,146 @@
+#include <glad/glad.h>
+
+#include "CityLod.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+
+CityLod::CityLod()
+	: pixelsPerUnit(1.0f), proxyCount(0), switchCount(0)
+{
+}
+
+
+/*
+BUILD
+	proxy box of every building (texture level of its first floor) and the triangle count of full blocks,
+	the proxies of a block are optimized for the vertex cache together (they are drawn together)
+*/
+void CityLod::build(const BuildingTable & buildings, const CityQuadtree & quadtree, const std::vector<glm::vec4> & cubePositions)
+{
+	nodes = quadtree.getNodes();
+	proxyState.assign(nodes.size(), 0);
+	blockTriangles.assign(nodes.size(), 0);
+	vertices.clear();
+	vertices.reserve(buildings.count * PROXY_INDICES * 8);
+
+	for (unsigned int b = 0; b < buildings.count; b++) {
+		glm::vec3 boxMin = buildings.center(b) - buildings.extent(b);
+		glm::vec3 size = buildings.extent(b) * 2.0f;
+		int level = std::min(std::max((int)cubePositions[buildings.firstCube[b]].w, 0), ATLAS_WIDTH - 1);
+		glm::vec2 wall((level + 0.5f) / ATLAS_WIDTH, 0.5f / ATLAS_HEIGHT);
+		glm::vec2 roof((level + 0.5f) / ATLAS_WIDTH, 1.5f / ATLAS_HEIGHT);
+		glm::vec3 dx(size.x, 0.0f, 0.0f), dy(0.0f, size.y, 0.0f), dz(0.0f, 0.0f, size.z);
+
+		// counter-clockwise seen from outside: side x up == normal
+		addFace(boxMin + dx, -dx, dy, glm::vec3(0.0f, 0.0f, -1.0f), wall);
+		addFace(boxMin + dz, dx, dy, glm::vec3(0.0f, 0.0f, 1.0f), wall);
+		addFace(boxMin, dz, dy, glm::vec3(-1.0f, 0.0f, 0.0f), wall);
+		addFace(boxMin + dx + dz, -dz, dy, glm::vec3(1.0f, 0.0f, 0.0f), wall);
+		addFace(boxMin + dy + dz, dx, -dz, glm::vec3(0.0f, 1.0f, 0.0f), roof);
+	}
+
+	// leaves cover the table one after another
+	std::vector<std::pair<unsigned int, unsigned int> > leaves;
+	for (unsigned int n = 0; n < nodes.size(); n++) {
+		const QuadtreeNode & node = nodes[n];
+		for (unsigned int b = node.firstBuilding; b < node.firstBuilding + node.buildingCount; b++)
+			blockTriangles[n] += buildings.cubeCount[b] * CUBE_TRIANGLES;
+		if (node.childCount == 0)
+			leaves.push_back(std::make_pair(node.firstBuilding, node.buildingCount * PROXY_TRIANGLES));
+	}
+	std::sort(leaves.begin(), leaves.end());
+	std::vector<unsigned int> groupTriangles;
+	for (size_t i = 0; i < leaves.size(); i++)
+		groupTriangles.push_back(leaves[i].second);
+
+	buildIndexedMesh(vertices.data(), vertices.size() / 8, 8, groupTriangles, &mesh, &meshStats);
+	std::vector<float>().swap(vertices);
+}
+
+void CityLod::addFace(const glm::vec3 & corner, const glm::vec3 & side, const glm::vec3 & up, const glm::vec3 & normal, const glm::vec2 & texCoords)
+{
+	const glm::vec3 points[6] = { corner, corner + side, corner + side + up, corner, corner + side + up, corner + up };
+	for (int i = 0; i < 6; i++) {
+		const float vertex[8] = { points[i].x, points[i].y, points[i].z, normal.x, normal.y, normal.z, texCoords.x, texCoords.y };
+		vertices.insert(vertices.end(), vertex, vertex + 8);
+	}
+}
+
+
+void CityLod::setProjection(float fovY, float viewportHeight)
+{
+	pixelsPerUnit = viewportHeight * 0.5f / tan(fovY * 0.5f);
+}
+
+float CityLod::screenSize(unsigned int block, const glm::vec3 & eye) const
+{
+	const QuadtreeNode & node = nodes[block];
+	float radius = glm::length(node.boxMax - node.boxMin) * 0.5f;
+	float distance = glm::length((node.boxMin + node.boxMax) * 0.5f - eye);
+	if (distance <= radius)
+		return INFINITY;
+	return 2.0f * radius * pixelsPerUnit / distance;
+}
+
+bool CityLod::useProxy(unsigned int block, const glm::vec3 & eye)
+{
+	float pixels = screenSize(block, eye);
+	unsigned char state = proxyState[block];
+	if (state && pixels > LOD_FULL_PIXELS)
+		state = 0;
+	else if (!state && pixels < LOD_PROXY_PIXELS)
+		state = 1;
+	if (state != proxyState[block]) {
+		proxyState[block] = state;
+		switchCount++;
+	}
+	proxyCount += state;
+	return state != 0;
+}
+
+
+/*
+LOD ATLAS
+	GL averages every texture while building its mipmaps, so the 1 x 1 level is the average color
+*/
+static void averageColor(unsigned int texture, unsigned char * rgb)
+{
+	GLint width = 1, height = 1;
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+	int topLevel = 0;
+	while ((std::max(width, height) >> topLevel) > 1)
+		topLevel++;
+	glGetTexImage(GL_TEXTURE_2D, topLevel, GL_RGB, GL_UNSIGNED_BYTE, rgb);
+}
+
+unsigned int bakeLodAtlas(const unsigned int levelTextures[][3])
+{
+	unsigned char atlas[CityLod::ATLAS_HEIGHT][CityLod::ATLAS_WIDTH][3];
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	for (int level = 0; level < CityLod::ATLAS_WIDTH; level++) {
+		unsigned char first[3], second[3];
+		averageColor(levelTextures[level][0], first);
+		averageColor(levelTextures[level][1], second);
+		for (int c = 0; c < 3; c++)
+			atlas[0][level][c] = (unsigned char)((first[c] + second[c] + 1) / 2);
+		averageColor(levelTextures[level][2], atlas[1][level]);
+	}
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+	unsigned int textureID;
+	glGenTextures(1, &textureID);
+	glBindTexture(GL_TEXTURE_2D, textureID);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, CityLod::ATLAS_WIDTH, CityLod::ATLAS_HEIGHT, 0, GL_RGB, GL_UNSIGNED_BYTE, atlas);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	return textureID;
+}
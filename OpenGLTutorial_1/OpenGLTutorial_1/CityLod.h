@@ -0,0 +1,82 @@
+#ifndef CITY_LOD_H
+#define CITY_LOD_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "BuildingTable.h"
+#include "CityQuadtree.h"
+#include "IndexedMesh.h"
+
+// a block switches to its proxy when it gets smaller than LOD_PROXY_PIXELS on screen
+// and back to full detail only when it is bigger than LOD_FULL_PIXELS, so it doesn't flicker on the border
+const float LOD_PROXY_PIXELS = 160.0f;
+const float LOD_FULL_PIXELS = 200.0f;
+
+/*
+CITY LOD
+	hierarchical level of detail of city blocks (quadtree leaves): every building has a proxy - one box
+	without the bottom face (10 triangles instead of 12 per floor) colored from a baked atlas of average
+	texture colors, so a far block is one draw call with one texture instead of a draw per face of every floor
+	proxies are one indexed mesh in the order of the building table (8 floats: position, normal, texture coords,
+	world space), a block draws indices <firstBuilding, firstBuilding + buildingCount) * PROXY_INDICES
+*/
+class CityLod
+{
+public:
+	static const unsigned int PROXY_INDICES = 30;
+	static const unsigned int PROXY_TRIANGLES = PROXY_INDICES / 3;
+	static const unsigned int CUBE_TRIANGLES = 12;
+	// atlas: column - texture level (w of cubePositions), row 0 - walls, row 1 - roof
+	static const int ATLAS_WIDTH = 4;
+	static const int ATLAS_HEIGHT = 2;
+
+	CityLod();
+
+	// buildings have to be in their final order (after CityQuadtree::build)
+	void build(const BuildingTable & buildings, const CityQuadtree & quadtree, const std::vector<glm::vec4> & cubePositions);
+
+	// vertical field of view in radians and height of the viewport in pixels
+	void setProjection(float fovY, float viewportHeight);
+
+	// height on screen of the block's bounding sphere in pixels
+	float screenSize(unsigned int block, const glm::vec3 & eye) const;
+
+	// proxy or full detail for the block (quadtree node index), the choice is kept for the next frame
+	bool useProxy(unsigned int block, const glm::vec3 & eye);
+
+	// triangles of the full block / of its proxy
+	unsigned int fullTriangles(unsigned int block) const { return blockTriangles[block]; }
+	unsigned int proxyTriangles(unsigned int block) const { return nodes[block].buildingCount * PROXY_TRIANGLES; }
+
+	const IndexedMesh & getMesh() const { return mesh; }
+	const MeshStats & getMeshStats() const { return meshStats; }
+	unsigned int firstIndex(unsigned int block) const { return nodes[block].firstBuilding * PROXY_INDICES; }
+	unsigned int indexCount(unsigned int block) const { return nodes[block].buildingCount * PROXY_INDICES; }
+
+	// statistics of the frame, cleared by resetStats
+	void resetStats() { proxyCount = 0; switchCount = 0; }
+	unsigned int proxyBlocks() const { return proxyCount; }
+	unsigned int switches() const { return switchCount; }
+
+private:
+	void addFace(const glm::vec3 & corner, const glm::vec3 & side, const glm::vec3 & up, const glm::vec3 & normal, const glm::vec2 & texCoords);
+
+	std::vector<QuadtreeNode> nodes;
+	std::vector<unsigned int> blockTriangles;
+	std::vector<unsigned char> proxyState;	// 1 - block drawn as the proxy in the last frame
+	std::vector<float> vertices;	// triangle list of the proxies while building
+	IndexedMesh mesh;
+	MeshStats meshStats;
+	float pixelsPerUnit;	// at distance 1
+
+	unsigned int proxyCount;
+	unsigned int switchCount;
+};
+
+// 4 x 2 texture of average colors: the smallest mip level of the wall (front/back and left/right averaged)
+// and roof textures of every level, levelTextures: front + back, left + right, bottom + top; textures have to have mipmaps
+unsigned int bakeLodAtlas(const unsigned int levelTextures[][3]);
+
+#endif
@@ -0,0 +1,223 @@
+#include "CityQuadtree.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+
+/*
+MORTON CODE
+	bits of x and z interleaved (x on even bits), 16 bits per axis is enough for 65536 cells
+	cells that are close on the grid get close codes, and every square of 2^k x 2^k cells
+	aligned to 2^k is one contiguous range of codes
+*/
+static unsigned int spreadBits(unsigned int value)
+{
+	value &= 0x0000FFFF;
+	value = (value | (value << 8)) & 0x00FF00FF;
+	value = (value | (value << 4)) & 0x0F0F0F0F;
+	value = (value | (value << 2)) & 0x33333333;
+	value = (value | (value << 1)) & 0x55555555;
+	return value;
+}
+
+static unsigned int mortonCode(unsigned int x, unsigned int z)
+{
+	return spreadBits(x) | (spreadBits(z) << 1);
+}
+
+
+/*
+BUILD
+	sort buildings by Morton code of their cell, then split code ranges recursively by 2 bits (4 quadrants)
+*/
+void CityQuadtree::build(BuildingTable * buildings)
+{
+	nodes.clear();
+	buildingLeaf.assign(buildings->count, 0);
+	treeDepth = 0;
+	if (buildings->count == 0)
+		return;
+
+	// cells relative to the lowest building, so codes start at 0
+	int minX = INT_MAX, minZ = INT_MAX, maxX = -INT_MAX, maxZ = -INT_MAX;
+	std::vector<int> cellX(buildings->count), cellZ(buildings->count);
+	for (size_t i = 0; i < buildings->count; i++) {
+		cellX[i] = (int)floor(buildings->centerX[i] + 0.5f);
+		cellZ[i] = (int)floor(buildings->centerZ[i] + 0.5f);
+		minX = std::min(minX, cellX[i]); maxX = std::max(maxX, cellX[i]);
+		minZ = std::min(minZ, cellZ[i]); maxZ = std::max(maxZ, cellZ[i]);
+	}
+
+	std::vector<std::pair<unsigned int, unsigned int> > keys(buildings->count);
+	for (size_t i = 0; i < buildings->count; i++)
+		keys[i] = std::make_pair(mortonCode(cellX[i] - minX, cellZ[i] - minZ), (unsigned int)i);
+	std::sort(keys.begin(), keys.end());
+
+	std::vector<unsigned int> order(buildings->count), codes(buildings->count);
+	for (size_t i = 0; i < keys.size(); i++) {
+		codes[i] = keys[i].first;
+		order[i] = keys[i].second;
+	}
+	buildings->reorder(order);
+
+	// smallest square of 2^bits cells that covers the city
+	int bits = 0;
+	while ((1 << bits) <= std::max(maxX - minX, maxZ - minZ))
+		bits++;
+
+	nodes.push_back(QuadtreeNode());
+	buildNode(0, codes, 0, (unsigned int)buildings->count, 2 * bits, 1, *buildings);
+}
+
+
+void CityQuadtree::buildNode(unsigned int index, const std::vector<unsigned int> & codes, unsigned int first,
+							 unsigned int count, int shift, int level, const BuildingTable & buildings)
+{
+	treeDepth = std::max(treeDepth, level);
+	nodes[index].firstBuilding = first;
+	nodes[index].buildingCount = count;
+	nodes[index].firstChild = 0;
+	nodes[index].childCount = 0;
+
+	if (count <= LEAF_BUILDINGS || shift == 0) {
+		for (unsigned int i = first; i < first + count; i++)
+			buildingLeaf[i] = index;
+		glm::vec3 boxMin(INFINITY), boxMax(-INFINITY);
+		float minHeight = INFINITY, maxHeight = -INFINITY;
+		for (unsigned int i = first; i < first + count; i++) {
+			glm::vec3 center = buildings.center(i), extent = buildings.extent(i);
+			boxMin = glm::min(boxMin, center - extent);
+			boxMax = glm::max(boxMax, center + extent);
+			minHeight = std::min(minHeight, center.y + extent.y);
+			maxHeight = std::max(maxHeight, center.y + extent.y);
+		}
+		nodes[index].boxMin = boxMin;
+		nodes[index].boxMax = boxMax;
+		nodes[index].minHeight = minHeight;
+		nodes[index].maxHeight = maxHeight;
+		return;
+	}
+
+	// quadrant of a building is given by the 2 highest bits still varying in this node
+	unsigned int quadrantFirst[5];
+	unsigned int i = first;
+	for (unsigned int quadrant = 0; quadrant < 4; quadrant++) {
+		quadrantFirst[quadrant] = i;
+		while (i < first + count && ((codes[i] >> (shift - 2)) & 3) == quadrant)
+			i++;
+	}
+	quadrantFirst[4] = first + count;
+
+	// children are allocated together, before any of them builds its own children
+	unsigned int firstChild = (unsigned int)nodes.size();
+	unsigned int childCount = 0;
+	for (unsigned int quadrant = 0; quadrant < 4; quadrant++) {
+		if (quadrantFirst[quadrant + 1] > quadrantFirst[quadrant])
+			childCount++;
+	}
+	nodes.resize(nodes.size() + childCount);
+	nodes[index].firstChild = firstChild;
+	nodes[index].childCount = childCount;
+
+	unsigned int child = firstChild;
+	for (unsigned int quadrant = 0; quadrant < 4; quadrant++) {
+		unsigned int quadrantCount = quadrantFirst[quadrant + 1] - quadrantFirst[quadrant];
+		if (quadrantCount > 0)
+			buildNode(child++, codes, quadrantFirst[quadrant], quadrantCount, shift - 2, level + 1, buildings);
+	}
+
+	glm::vec3 boxMin(INFINITY), boxMax(-INFINITY);
+	float minHeight = INFINITY, maxHeight = -INFINITY;
+	for (unsigned int c = firstChild; c < firstChild + childCount; c++) {
+		boxMin = glm::min(boxMin, nodes[c].boxMin);
+		boxMax = glm::max(boxMax, nodes[c].boxMax);
+		minHeight = std::min(minHeight, nodes[c].minHeight);
+		maxHeight = std::max(maxHeight, nodes[c].maxHeight);
+	}
+	nodes[index].boxMin = boxMin;
+	nodes[index].boxMax = boxMax;
+	nodes[index].minHeight = minHeight;
+	nodes[index].maxHeight = maxHeight;
+}
+
+
+/*
+CULL FRUSTUM
+	district outside - skipped, fully inside - all its buildings at once,
+	crossing the border - children, or SIMD test of the buildings in a leaf
+*/
+void CityQuadtree::cullFrustum(const Frustum & frustum, const BuildingTable & buildings, std::vector<unsigned int> * visibleBuildings) const
+{
+	if (nodes.empty())
+		return;
+
+	unsigned int stack[64 * 4];
+	int top = 0;
+	stack[top++] = 0;
+	while (top > 0) {
+		const QuadtreeNode & node = nodes[stack[--top]];
+		glm::vec3 center = (node.boxMin + node.boxMax) * 0.5f;
+		glm::vec3 extent = (node.boxMax - node.boxMin) * 0.5f;
+
+		Frustum_Test test = classifyBox(frustum, center, extent);
+		if (test == BOX_OUTSIDE)
+			continue;
+		if (test == BOX_INSIDE) {
+			for (unsigned int i = node.firstBuilding; i < node.firstBuilding + node.buildingCount; i++)
+				visibleBuildings->push_back(i);
+		}
+		else if (node.childCount == 0) {
+			cullBuildings(frustum, buildings, node.firstBuilding, node.buildingCount, visibleBuildings);
+		}
+		else {
+			for (unsigned int c = node.firstChild; c < node.firstChild + node.childCount; c++)
+				stack[top++] = c;
+		}
+	}
+}
+
+
+/*
+QUERY RADIUS
+	distance from the point to a box is the length of the point's offset outside the box on every axis
+*/
+static float squaredDistanceToBox(const glm::vec3 & point, const glm::vec3 & boxMin, const glm::vec3 & boxMax)
+{
+	glm::vec3 offset = glm::max(glm::max(boxMin - point, point - boxMax), glm::vec3(0.0f));
+	return glm::dot(offset, offset);
+}
+
+void CityQuadtree::queryRadius(const glm::vec3 & center, float radius, const BuildingTable & buildings, std::vector<unsigned int> * result) const
+{
+	if (nodes.empty())
+		return;
+
+	const float radius2 = radius * radius;
+	unsigned int stack[64 * 4];
+	int top = 0;
+	stack[top++] = 0;
+	while (top > 0) {
+		const QuadtreeNode & node = nodes[stack[--top]];
+		if (squaredDistanceToBox(center, node.boxMin, node.boxMax) > radius2)
+			continue;
+
+		// the farthest corner is in range - the whole district is
+		glm::vec3 farthest = glm::max(glm::abs(node.boxMin - center), glm::abs(node.boxMax - center));
+		if (glm::dot(farthest, farthest) <= radius2) {
+			for (unsigned int i = node.firstBuilding; i < node.firstBuilding + node.buildingCount; i++)
+				result->push_back(i);
+		}
+		else if (node.childCount == 0) {
+			for (unsigned int i = node.firstBuilding; i < node.firstBuilding + node.buildingCount; i++) {
+				glm::vec3 c = buildings.center(i), e = buildings.extent(i);
+				if (squaredDistanceToBox(center, c - e, c + e) <= radius2)
+					result->push_back(i);
+			}
+		}
+		else {
+			for (unsigned int c = node.firstChild; c < node.firstChild + node.childCount; c++)
+				stack[top++] = c;
+		}
+	}
+}
@@ -0,0 +1,62 @@
+#ifndef CITY_QUADTREE_H
+#define CITY_QUADTREE_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "BuildingTable.h"
+#include "FrustumCulling.h"
+
+// One square district of the city
+struct QuadtreeNode {
+	glm::vec3 boxMin;			// bounds of all buildings of the node
+	glm::vec3 boxMax;
+	float minHeight;			// lowest and highest roof in the node
+	float maxHeight;
+	unsigned int firstChild;	// children are stored one after another, childCount == 0 - leaf
+	unsigned int childCount;
+	unsigned int firstBuilding;	// buildings of the node: <firstBuilding, firstBuilding + buildingCount) of the table
+	unsigned int buildingCount;
+};
+
+/*
+CITY QUADTREE
+	static hierarchy of districts over the building grid
+	build sorts the building table in Morton (Z-curve) order of cells, so every node owns
+	a contiguous range of the table - a district fully inside a query is accepted without touching its buildings
+*/
+class CityQuadtree
+{
+public:
+	CityQuadtree() : treeDepth(0) {}
+
+	// buildings in a leaf, smaller leaves mean more nodes but fewer per-building tests
+	static const unsigned int LEAF_BUILDINGS = 16;
+
+	// reorders the table (firstCube / cubeCount keep pointing to the right cubes)
+	void build(BuildingTable * buildings);
+
+	// indices of buildings at least partly inside the frustum
+	void cullFrustum(const Frustum & frustum, const BuildingTable & buildings, std::vector<unsigned int> * visibleBuildings) const;
+
+	// indices of buildings whose box is closer than radius to the point
+	void queryRadius(const glm::vec3 & center, float radius, const BuildingTable & buildings, std::vector<unsigned int> * result) const;
+
+	const std::vector<QuadtreeNode> & getNodes() const { return nodes; }
+	int depth() const { return treeDepth; }
+
+	// index of the leaf node (city block) holding the building
+	unsigned int leafOf(unsigned int building) const { return buildingLeaf[building]; }
+
+private:
+	// node index - the node is already allocated, shift - number of Morton bits still varying in the node
+	void buildNode(unsigned int index, const std::vector<unsigned int> & codes, unsigned int first,
+				   unsigned int count, int shift, int level, const BuildingTable & buildings);
+
+	std::vector<QuadtreeNode> nodes;	// nodes[0] - whole city
+	std::vector<unsigned int> buildingLeaf;
+	int treeDepth;
+};
+
+#endif
@@ -0,0 +1,269 @@
+#define _CRT_SECURE_NO_DEPRECATE
+
+#include "CitySnapshot.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+/*
+BYTE ORDER
+	snapshot is always little-endian, big-endian machines swap every 4-byte word while writing
+	(byte arrays such as the height map are written as they are)
+*/
+static bool isLittleEndian() {
+	const uint32_t probe = 1;
+	return *(const unsigned char *)&probe == 1;
+}
+
+static void writeLittleEndian(FILE * file, const void * words, size_t bytes, size_t wordSize = 4) {
+	if (isLittleEndian() || wordSize == 1) {
+		fwrite(words, 1, bytes, file);
+		return;
+	}
+	const unsigned char * source = (const unsigned char *)words;
+	for (size_t i = 0; i + 4 <= bytes; i += 4) {
+		unsigned char swapped[4] = { source[i + 3], source[i + 2], source[i + 1], source[i] };
+		fwrite(swapped, 1, 4, file);
+	}
+}
+
+static void writeU64(FILE * file, uint64_t value) {
+	unsigned char bytes[8];
+	for (int i = 0; i < 8; i++)
+		bytes[i] = (unsigned char)(value >> (8 * i));
+	fwrite(bytes, 1, 8, file);
+}
+
+static void writePadding(FILE * file, uint64_t * offset) {
+	static const unsigned char zeros[SNAPSHOT_ALIGNMENT] = { 0 };
+	uint64_t aligned = (*offset + SNAPSHOT_ALIGNMENT - 1) / SNAPSHOT_ALIGNMENT * SNAPSHOT_ALIGNMENT;
+	fwrite(zeros, 1, (size_t)(aligned - *offset), file);
+	*offset = aligned;
+}
+
+
+CitySnapshot::CitySnapshot()
+	: data(NULL), dataSize(0), sections(NULL), fileHandle(NULL), mappingHandle(NULL), fileDescriptor(-1)
+{
+	memset(&header, 0, sizeof(header));
+}
+
+CitySnapshot::~CitySnapshot()
+{
+	close();
+}
+
+
+/*
+WRITE
+	header, section table and then every array aligned to SNAPSHOT_ALIGNMENT
+*/
+bool CitySnapshot::write(const char * fileName, const CityData & city)
+{
+	struct Source {
+		uint32_t id;
+		uint32_t elementSize;
+		const void * data;
+		uint64_t count;
+		uint32_t wordSize;
+	};
+	const Source sources[] = {
+		{ SECTION_CUBES, sizeof(glm::vec4), city.cubePositions->data(), city.cubePositions->size(), 4 },
+		{ SECTION_CROSSINGS, sizeof(glm::vec3), city.crossingPositions->data(), city.crossingPositions->size(), 4 },
+		{ SECTION_STREETS, sizeof(glm::vec3), city.streetPositions->data(), city.streetPositions->size(), 4 },
+		{ SECTION_STREETS2, sizeof(glm::vec3), city.street2Positions->data(), city.street2Positions->size(), 4 },
+		{ SECTION_HEIGHT_MAP, sizeof(HeightCell), city.heightMap->data(), city.heightMap->size(), 1 },
+		{ SECTION_BUILDING_MESH, sizeof(float), city.buildingMesh, city.buildingMeshSize / sizeof(float), 4 },
+		{ SECTION_GROUND_MESH, sizeof(float), city.groundMesh, city.groundMeshSize / sizeof(float), 4 }
+	};
+	const uint32_t sectionCount = sizeof(sources) / sizeof(sources[0]);
+
+	FILE * file = fopen(fileName, "wb");
+	if (file == NULL) {
+		std::cout << "Snapshot can't be written to: " << fileName << std::endl;
+		return false;
+	}
+
+	const uint32_t headerWords[6] = { SNAPSHOT_MAGIC, SNAPSHOT_VERSION, SNAPSHOT_BYTE_ORDER_MARK,
+									  city.sizeOfCity, city.seed, sectionCount };
+	writeLittleEndian(file, headerWords, sizeof(headerWords));
+
+	// offsets of arrays are known up front, so the table is written before the data
+	uint64_t offset = sizeof(Header) + sectionCount * sizeof(SectionEntry);
+	for (uint32_t i = 0; i < sectionCount; i++) {
+		offset = (offset + SNAPSHOT_ALIGNMENT - 1) / SNAPSHOT_ALIGNMENT * SNAPSHOT_ALIGNMENT;
+		const uint32_t entryWords[2] = { sources[i].id, sources[i].elementSize };
+		writeLittleEndian(file, entryWords, sizeof(entryWords));
+		writeU64(file, offset);
+		writeU64(file, sources[i].count);
+		offset += sources[i].count * sources[i].elementSize;
+	}
+
+	offset = sizeof(Header) + sectionCount * sizeof(SectionEntry);
+	for (uint32_t i = 0; i < sectionCount; i++) {
+		writePadding(file, &offset);
+		size_t bytes = (size_t)(sources[i].count * sources[i].elementSize);
+		writeLittleEndian(file, sources[i].data, bytes, sources[i].wordSize);
+		offset += bytes;
+	}
+
+	bool ok = ferror(file) == 0;
+	fclose(file);
+	if (!ok)
+		std::cout << "Snapshot write failed: " << fileName << std::endl;
+	return ok;
+}
+
+
+/*
+OPEN
+	map the whole file read-only and check that the section table stays inside of it
+*/
+bool CitySnapshot::open(const char * fileName)
+{
+	close();
+
+	if (!isLittleEndian()) {
+		std::cout << "Snapshot can be mapped only on little-endian machines" << std::endl;
+		return false;
+	}
+
+#if defined(_WIN32)
+	HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) {
+		std::cout << "Snapshot failed to open at path: " << fileName << std::endl;
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	GetFileSizeEx(file, &fileSize);
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	const void * view = mapping != NULL ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+	fileHandle = file;
+	mappingHandle = mapping;
+	data = (const unsigned char *)view;
+	dataSize = (size_t)fileSize.QuadPart;
+#else
+	fileDescriptor = ::open(fileName, O_RDONLY);
+	if (fileDescriptor < 0) {
+		std::cout << "Snapshot failed to open at path: " << fileName << std::endl;
+		return false;
+	}
+	struct stat fileStat;
+	fstat(fileDescriptor, &fileStat);
+	dataSize = (size_t)fileStat.st_size;
+	void * view = dataSize > 0 ? mmap(NULL, dataSize, PROT_READ, MAP_PRIVATE, fileDescriptor, 0) : MAP_FAILED;
+	data = view != MAP_FAILED ? (const unsigned char *)view : NULL;
+#endif
+
+	if (data == NULL || dataSize < sizeof(Header)) {
+		std::cout << "Snapshot failed to map: " << fileName << std::endl;
+		close();
+		return false;
+	}
+
+	memcpy(&header, data, sizeof(Header));
+	if (header.magic != SNAPSHOT_MAGIC || header.byteOrderMark != SNAPSHOT_BYTE_ORDER_MARK) {
+		std::cout << "Not a city snapshot: " << fileName << std::endl;
+		close();
+		return false;
+	}
+	if (header.version != SNAPSHOT_VERSION) {
+		std::cout << "Snapshot version " << header.version << " is not supported (expected "
+				  << SNAPSHOT_VERSION << "): " << fileName << std::endl;
+		close();
+		return false;
+	}
+
+	uint64_t tableEnd = sizeof(Header) + (uint64_t)header.sectionCount * sizeof(SectionEntry);
+	if (tableEnd > dataSize) {
+		std::cout << "Snapshot section table is truncated: " << fileName << std::endl;
+		close();
+		return false;
+	}
+	sections = (const SectionEntry *)(data + sizeof(Header));
+	for (uint32_t i = 0; i < header.sectionCount; i++) {
+		const SectionEntry & entry = sections[i];
+		// count * elementSize could wrap around on a corrupt file, so the count is compared instead
+		if (entry.elementSize == 0 || entry.offset % SNAPSHOT_ALIGNMENT != 0 || entry.offset > dataSize ||
+			entry.count > (dataSize - entry.offset) / entry.elementSize) {
+			std::cout << "Snapshot section " << entry.id << " is out of file bounds: " << fileName << std::endl;
+			close();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+/*
+CLOSE
+	unmap file and release handles
+*/
+void CitySnapshot::close()
+{
+#if defined(_WIN32)
+	if (data != NULL)
+		UnmapViewOfFile(data);
+	if (mappingHandle != NULL)
+		CloseHandle((HANDLE)mappingHandle);
+	if (fileHandle != NULL)
+		CloseHandle((HANDLE)fileHandle);
+#else
+	if (data != NULL)
+		munmap((void *)data, dataSize);
+	if (fileDescriptor >= 0)
+		::close(fileDescriptor);
+#endif
+	data = NULL;
+	dataSize = 0;
+	sections = NULL;
+	fileHandle = NULL;
+	mappingHandle = NULL;
+	fileDescriptor = -1;
+	memset(&header, 0, sizeof(header));
+}
+
+
+const void * CitySnapshot::section(Snapshot_Section id, size_t * count) const
+{
+	for (uint32_t i = 0; sections != NULL && i < header.sectionCount; i++) {
+		if (sections[i].id == (uint32_t)id) {
+			*count = (size_t)sections[i].count;
+			return data + sections[i].offset;
+		}
+	}
+	*count = 0;
+	return NULL;
+}
+
+
+const void * CitySnapshot::sectionOfSize(Snapshot_Section id, size_t elementSize, size_t * count) const
+{
+	for (uint32_t i = 0; sections != NULL && i < header.sectionCount; i++) {
+		if (sections[i].id == (uint32_t)id) {
+			if (sections[i].elementSize != elementSize) {
+				std::cout << "Snapshot section " << id << " has element size " << sections[i].elementSize
+						  << ", expected " << elementSize << std::endl;
+				break;
+			}
+			*count = (size_t)sections[i].count;
+			return data + sections[i].offset;
+		}
+	}
+	*count = 0;
+	return NULL;
+}
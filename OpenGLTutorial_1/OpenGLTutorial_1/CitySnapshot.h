@@ -0,0 +1,122 @@
+#ifndef CITY_SNAPSHOT_H
+#define CITY_SNAPSHOT_H
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "HeightMap.h"
+
+/*
+CITY SNAPSHOT
+	binary image of a generated city, used to run benchmarks and regressions on the same city again
+
+	layout (every value is stored little-endian, independent of the machine that wrote it):
+		header		magic "PGCS", format version, byte order mark, size of city, seed, number of sections
+		sections	table of { id, element size, offset, count } followed by the raw arrays
+
+	every array starts on a SNAPSHOT_ALIGNMENT boundary, so after mapping the file
+	it can be used in place as glm::vec3 / glm::vec4 / float / HeightCell data - nothing is parsed
+	(the meshes are used in place, positions and the height map are copied out with one memcpy per section)
+*/
+
+const uint32_t SNAPSHOT_MAGIC = 0x53434750;			// "PGCS"
+const uint32_t SNAPSHOT_VERSION = 2;
+const uint32_t SNAPSHOT_BYTE_ORDER_MARK = 0x01020304;
+const uint32_t SNAPSHOT_ALIGNMENT = 64;
+
+// Ids of arrays stored in a snapshot
+enum Snapshot_Section {
+	SECTION_CUBES = 1,			// glm::vec4 (x, y, z, texture level) per building floor
+	SECTION_CROSSINGS = 2,		// glm::vec3 per crossing
+	SECTION_STREETS = 3,		// glm::vec3 per vertical street
+	SECTION_STREETS2 = 4,		// glm::vec3 per horizontal street
+	SECTION_HEIGHT_MAP = 5,		// HeightCell per cell of the grid, z-major
+	SECTION_BUILDING_MESH = 6,	// float, 8 per vertex (position, normal, texture coords)
+	SECTION_GROUND_MESH = 7		// float, 8 per vertex (position, normal, texture coords)
+};
+
+// Everything that describes one generated city, used as input of CitySnapshot::write
+struct CityData {
+	uint32_t sizeOfCity;
+	uint32_t seed;
+	const std::vector<glm::vec4> * cubePositions;
+	const std::vector<glm::vec3> * crossingPositions;
+	const std::vector<glm::vec3> * streetPositions;
+	const std::vector<glm::vec3> * street2Positions;
+	const HeightMap * heightMap;
+	const float * buildingMesh;
+	size_t buildingMeshSize;	// in bytes
+	const float * groundMesh;
+	size_t groundMeshSize;		// in bytes
+};
+
+// Read-only, memory-mapped city snapshot
+class CitySnapshot
+{
+public:
+	CitySnapshot();
+	~CitySnapshot();
+
+	// serialize city to the file, returns false if the file can't be written
+	static bool write(const char * fileName, const CityData & city);
+
+	// map the file into memory and validate header and section table
+	bool open(const char * fileName);
+	void close();
+
+	bool isOpen() const { return data != NULL; }
+	uint32_t sizeOfCity() const { return header.sizeOfCity; }
+	uint32_t seed() const { return header.seed; }
+
+	// pointer to the mapped array of given section or NULL if it is missing; count is number of elements
+	const void * section(Snapshot_Section id, size_t * count) const;
+
+	// copy section into the vector (a single memcpy, no conversion)
+	template <typename T>
+	bool copySection(Snapshot_Section id, std::vector<T> * out) const
+	{
+		size_t count = 0;
+		const T * first = static_cast<const T *>(sectionOfSize(id, sizeof(T), &count));
+		if (first == NULL)
+			return false;
+		out->assign(first, first + count);
+		return true;
+	}
+
+private:
+	struct Header {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t byteOrderMark;
+		uint32_t sizeOfCity;
+		uint32_t seed;
+		uint32_t sectionCount;
+	};
+
+	struct SectionEntry {
+		uint32_t id;
+		uint32_t elementSize;
+		uint64_t offset;
+		uint64_t count;
+	};
+
+	const void * sectionOfSize(Snapshot_Section id, size_t elementSize, size_t * count) const;
+
+	Header header;
+	const unsigned char * data;
+	size_t dataSize;
+	const SectionEntry * sections;
+
+	// platform handles of the mapping
+	void * fileHandle;
+	void * mappingHandle;
+	int fileDescriptor;
+
+	CitySnapshot(const CitySnapshot &);
+	CitySnapshot & operator=(const CitySnapshot &);
+};
+
+#endif
@@ -0,0 +1,84 @@
+#include "DrawOrder.h"
+
+#include <algorithm>
+#include <cmath>
+
+// distance of the point from the box, 0 inside
+static float boxDistance(const glm::vec3 & point, const glm::vec3 & boxMin, const glm::vec3 & boxMax)
+{
+	glm::vec3 outside = glm::max(glm::max(boxMin - point, point - boxMax), glm::vec3(0.0f));
+	return glm::length(outside);
+}
+
+
+void DrawOrder::sortFrontToBack(const glm::vec3 & eye, const BuildingTable & buildings, const CityQuadtree & quadtree,
+								std::vector<unsigned int> * visibleBuildings)
+{
+	std::vector<unsigned int> & visible = *visibleBuildings;
+	const std::vector<QuadtreeNode> & nodes = quadtree.getNodes();
+
+	// runs of one block and their distances
+	runs.clear();
+	distances.clear();
+	sliceStarts.assign(1, 0);
+	float farthest = 0.0f;
+	for (unsigned int b = 0; b < visible.size(); ) {
+		unsigned int block = quadtree.leafOf(visible[b]);
+		Run run = { b, 0, 0 };
+		while (b < visible.size() && quadtree.leafOf(visible[b]) == block) {
+			b++;
+			run.count++;
+		}
+		float distance = boxDistance(eye, nodes[block].boxMin, nodes[block].boxMax);
+		farthest = std::max(farthest, distance);
+		runs.push_back(run);
+		distances.push_back(distance);
+	}
+	blockCount = (unsigned int)runs.size();
+	if (visible.size() < 2)
+		return;
+
+	// counting sort of the runs by bucket
+	bucketStarts.assign(BUCKETS + 1, 0);
+	for (size_t r = 0; r < runs.size(); r++) {
+		unsigned int bucket = 0;
+		if (farthest > 0.0f)
+			bucket = std::min((unsigned int)(std::sqrt(distances[r] / farthest) * BUCKETS), (unsigned int)BUCKETS - 1);
+		runs[r].bucket = bucket;
+		bucketStarts[bucket + 1]++;
+	}
+	for (int bucket = 0; bucket < BUCKETS; bucket++)
+		bucketStarts[bucket + 1] += bucketStarts[bucket];
+	order.resize(runs.size());
+	for (size_t r = 0; r < runs.size(); r++)
+		order[bucketStarts[runs[r].bucket]++] = (unsigned int)r;
+
+	// buildings of a block nearest first (insertion sort, a block has at most LEAF_BUILDINGS)
+	sorted.clear();
+	int slice = 0;
+	for (size_t i = 0; i < order.size(); i++) {
+		const Run & run = runs[order[i]];
+		size_t first = sorted.size();
+		if ((int)run.bucket * SLICES / BUCKETS > slice) {
+			slice = (int)run.bucket * SLICES / BUCKETS;
+			if (first > 0)
+				sliceStarts.push_back((unsigned int)first);
+		}
+		for (unsigned int b = run.first; b < run.first + run.count; b++) {
+			unsigned int building = visible[b];
+			glm::vec3 toBuilding = buildings.center(building) - eye;
+			float distance = glm::dot(toBuilding, toBuilding);
+			size_t place = sorted.size();
+			sorted.push_back(building);
+			while (place > first) {
+				glm::vec3 toPrevious = buildings.center(sorted[place - 1]) - eye;
+				if (glm::dot(toPrevious, toPrevious) <= distance)
+					break;
+				sorted[place] = sorted[place - 1];
+				place--;
+			}
+			sorted[place] = building;
+		}
+	}
+	visible.swap(sorted);
+}
@@ -0,0 +1,55 @@
+#ifndef DRAW_ORDER_H
+#define DRAW_ORDER_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "BuildingTable.h"
+#include "CityQuadtree.h"
+
+/*
+DRAW ORDER
+	front-to-back order of the visible buildings, so the depth test rejects hidden fragments before
+	lighting_maps.fs samples and shades them
+	the list stays grouped by city block (the render loop draws, queries and swaps to proxies per block):
+	blocks go to BUCKETS buckets by the distance of their box from the eye (a counting sort, linear time,
+	blocks of one bucket keep their quadtree order), buildings inside a block are sorted by distance directly
+	buckets are finer near the eye (square root of the distance), where the overdraw is the biggest
+	the sorted list is also cut into SLICES runs of buckets, so draws batched by something else (texture
+	level of pulled buildings) can still go front-to-back slice by slice
+*/
+class DrawOrder
+{
+public:
+	static const int BUCKETS = 64;
+	static const int SLICES = 4;
+
+	DrawOrder() : blockCount(0) {}
+
+	// reorders visibleBuildings (buildings of one block have to follow each other)
+	void sortFrontToBack(const glm::vec3 & eye, const BuildingTable & buildings, const CityQuadtree & quadtree,
+						 std::vector<unsigned int> * visibleBuildings);
+
+	// blocks sorted in the last call
+	unsigned int sortedBlocks() const { return blockCount; }
+	// positions in the sorted list where a new distance slice starts (ascending, the first one is 0)
+	const std::vector<unsigned int> & getSliceStarts() const { return sliceStarts; }
+
+private:
+	// buildings <first, first + count) of the visible list, all from one block
+	struct Run {
+		unsigned int first, count;
+		unsigned int bucket;
+	};
+
+	std::vector<Run> runs;
+	std::vector<float> distances;			// of the runs while bucketing
+	std::vector<unsigned int> bucketStarts;
+	std::vector<unsigned int> order;		// runs in bucket order
+	std::vector<unsigned int> sorted;
+	std::vector<unsigned int> sliceStarts;
+	unsigned int blockCount;
+};
+
+#endif
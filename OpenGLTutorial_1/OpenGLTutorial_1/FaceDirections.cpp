@@ -0,0 +1,28 @@
+#include "FaceDirections.h"
+
+
+unsigned int facesTowardEye(const glm::vec3 & eye, const glm::vec3 & center, const glm::vec3 & extent)
+{
+	unsigned int faces = 0;
+	if (eye.z < center.z - extent.z)
+		faces |= 1u << FACE_BACK;
+	else if (eye.z > center.z + extent.z)
+		faces |= 1u << FACE_FRONT;
+	if (eye.x < center.x - extent.x)
+		faces |= 1u << FACE_LEFT;
+	else if (eye.x > center.x + extent.x)
+		faces |= 1u << FACE_RIGHT;
+	if (eye.y < center.y - extent.y)
+		faces |= 1u << FACE_BOTTOM;
+	else if (eye.y > center.y + extent.y)
+		faces |= 1u << FACE_TOP;
+	return faces;
+}
+
+int faceCount(unsigned int faces)
+{
+	int count = 0;
+	for (; faces != 0; faces &= faces - 1)
+		count++;
+	return count;
+}
@@ -0,0 +1,30 @@
+#ifndef FACE_DIRECTIONS_H
+#define FACE_DIRECTIONS_H
+
+#include <glm/glm.hpp>
+
+// Faces of an axis-aligned box in the order of verticesTab3 (building mesh, building_pulling.vs), 6 vertices each
+enum Face_Direction {
+	FACE_BACK,		// -Z
+	FACE_FRONT,		// +Z
+	FACE_LEFT,		// -X
+	FACE_RIGHT,		// +X
+	FACE_BOTTOM,	// -Y
+	FACE_TOP,		// +Y
+	FACE_COUNT
+};
+
+const unsigned int ALL_FACES = (1u << FACE_COUNT) - 1;
+
+/*
+FACES TOWARD EYE
+	bit (1 << Face_Direction) for every face of the box center +- extent whose outer side the eye sees:
+	the eye is beyond the plane of the face, all other faces are back faces from there
+	at most one face per axis, the eye inside the box's span on an axis sees neither face of that axis
+*/
+unsigned int facesTowardEye(const glm::vec3 & eye, const glm::vec3 & center, const glm::vec3 & extent);
+
+// number of faces in the mask
+int faceCount(unsigned int faces);
+
+#endif
@@ -0,0 +1,51 @@
+#include "FrameStats.h"
+
+#include <iomanip>
+#include <iostream>
+
+
+FrameStats::Entry & FrameStats::entry(const char * name, bool isTime)
+{
+	for (size_t i = 0; i < entries.size(); i++) {
+		if (entries[i].name == name)
+			return entries[i];
+	}
+	Entry created = { name, isTime, 0.0, 0.0 };
+	entries.push_back(created);
+	return entries.back();
+}
+
+
+double FrameStats::average(const char * name) const
+{
+	for (size_t i = 0; i < entries.size(); i++) {
+		if (entries[i].name == name)
+			return entries[i].lastAverage;
+	}
+	return 0.0;
+}
+
+
+/*
+END FRAME
+	one console line per interval: "name value | name value [ms] | ..."
+*/
+void FrameStats::endFrame(double now)
+{
+	if (intervalStart < 0.0)
+		intervalStart = now;
+	frames++;
+	if (now - intervalStart < interval)
+		return;
+
+	std::cout << std::fixed << std::setprecision(3) << frames / (now - intervalStart) << " fps";
+	for (size_t i = 0; i < entries.size(); i++) {
+		entries[i].lastAverage = entries[i].sum / frames;
+		entries[i].sum = 0.0;
+		std::cout << " | " << entries[i].name << " " << entries[i].lastAverage << (entries[i].isTime ? " ms" : "");
+	}
+	std::cout << std::endl;
+
+	intervalStart = now;
+	frames = 0;
+}
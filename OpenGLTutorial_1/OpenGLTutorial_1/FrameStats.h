@@ -0,0 +1,60 @@
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/*
+FRAME STATS
+	named per-frame measurements (times in milliseconds and counts),
+	averaged over all frames of the interval and printed to the console once per interval
+*/
+class FrameStats
+{
+public:
+	FrameStats(double intervalSeconds = 1.0) : interval(intervalSeconds), intervalStart(-1.0), frames(0) {}
+
+	void addTime(const char * name, double milliseconds) { entry(name, true).sum += milliseconds; }
+	void addCount(const char * name, double value) { entry(name, false).sum += value; }
+
+	// average per frame over the last finished interval, 0 if unknown
+	double average(const char * name) const;
+
+	// close the frame, print and restart averages when the interval is over (now in seconds)
+	void endFrame(double now);
+
+private:
+	struct Entry {
+		std::string name;
+		bool isTime;
+		double sum;
+		double lastAverage;
+	};
+
+	Entry & entry(const char * name, bool isTime);
+
+	double interval;
+	double intervalStart;
+	int frames;
+	std::vector<Entry> entries;
+};
+
+// Measures time from construction to destruction and adds it to the stats
+class ScopedTimer
+{
+public:
+	ScopedTimer(FrameStats & stats, const char * name)
+		: stats(stats), name(name), start(std::chrono::high_resolution_clock::now()) {}
+	~ScopedTimer()
+	{
+		stats.addTime(name, std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+	}
+
+private:
+	FrameStats & stats;
+	const char * name;
+	std::chrono::high_resolution_clock::time_point start;
+};
+
+#endif
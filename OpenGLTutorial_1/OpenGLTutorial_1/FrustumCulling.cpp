@@ -0,0 +1,184 @@
+#include "FrustumCulling.h"
+
+#include <cmath>
+
+// glm/glm.hpp includes the intrinsics matching GLM_ARCH (see glm/simd/platform.h)
+
+
+Frustum extractFrustum(const glm::mat4 & viewProjection)
+{
+	// glm matrices are column-major, row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+	glm::vec4 rows[4];
+	for (int i = 0; i < 4; i++)
+		rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+
+	Frustum frustum;
+	frustum.planes[0] = rows[3] + rows[0];
+	frustum.planes[1] = rows[3] - rows[0];
+	frustum.planes[2] = rows[3] + rows[1];
+	frustum.planes[3] = rows[3] - rows[1];
+	frustum.planes[4] = rows[3] + rows[2];
+	frustum.planes[5] = rows[3] - rows[2];
+	for (int i = 0; i < 6; i++)
+		frustum.planes[i] /= glm::length(glm::vec3(frustum.planes[i]));
+	return frustum;
+}
+
+
+float farCornerDistance(float fovY, float aspect, float farPlane)
+{
+	float tanHalf = std::tan(fovY * 0.5f);
+	return farPlane * std::sqrt(1.0f + tanHalf * tanHalf * (1.0f + aspect * aspect));
+}
+
+
+/*
+box is outside when it is fully behind any plane:
+	distance of the center + projection of the extent on the plane normal < 0
+*/
+bool isBoxVisible(const Frustum & frustum, const glm::vec3 & center, const glm::vec3 & extent)
+{
+	for (int i = 0; i < 6; i++) {
+		const glm::vec4 & plane = frustum.planes[i];
+		float distance = glm::dot(glm::vec3(plane), center) + plane.w + glm::dot(glm::abs(glm::vec3(plane)), extent);
+		if (distance < 0.0f)
+			return false;
+	}
+	return true;
+}
+
+
+Frustum_Test classifyBox(const Frustum & frustum, const glm::vec3 & center, const glm::vec3 & extent)
+{
+	Frustum_Test result = BOX_INSIDE;
+	for (int i = 0; i < 6; i++) {
+		const glm::vec4 & plane = frustum.planes[i];
+		float distance = glm::dot(glm::vec3(plane), center) + plane.w;
+		float radius = glm::dot(glm::abs(glm::vec3(plane)), extent);
+		if (distance + radius < 0.0f)
+			return BOX_OUTSIDE;
+		if (distance - radius < 0.0f)
+			result = BOX_INTERSECTS;
+	}
+	return result;
+}
+
+
+void cullBuildings(const Frustum & frustum, const BuildingTable & buildings, std::vector<unsigned int> * visibleBuildings)
+{
+	cullBuildings(frustum, buildings, 0, buildings.count, visibleBuildings);
+}
+
+
+#if GLM_ARCH & GLM_ARCH_AVX_BIT
+
+void cullBuildings(const Frustum & frustum, const BuildingTable & buildings, size_t first, size_t count,
+				   std::vector<unsigned int> * visibleBuildings)
+{
+	__m256 normalX[6], normalY[6], normalZ[6], absX[6], absY[6], absZ[6], offset[6];
+	for (int p = 0; p < 6; p++) {
+		const glm::vec4 & plane = frustum.planes[p];
+		normalX[p] = _mm256_set1_ps(plane.x);
+		normalY[p] = _mm256_set1_ps(plane.y);
+		normalZ[p] = _mm256_set1_ps(plane.z);
+		absX[p] = _mm256_set1_ps(fabs(plane.x));
+		absY[p] = _mm256_set1_ps(fabs(plane.y));
+		absZ[p] = _mm256_set1_ps(fabs(plane.z));
+		offset[p] = _mm256_set1_ps(plane.w);
+	}
+	const __m256 zero = _mm256_setzero_ps();
+
+	// lanes past the end of the range are loaded (the table is padded) but never reported
+	const size_t end = first + count;
+	size_t i = first;
+	for (; i < end && i + 8 <= buildings.paddedCount(); i += 8) {
+		__m256 cx = _mm256_loadu_ps(&buildings.centerX[i]);
+		__m256 cy = _mm256_loadu_ps(&buildings.centerY[i]);
+		__m256 cz = _mm256_loadu_ps(&buildings.centerZ[i]);
+		__m256 ex = _mm256_loadu_ps(&buildings.extentX[i]);
+		__m256 ey = _mm256_loadu_ps(&buildings.extentY[i]);
+		__m256 ez = _mm256_loadu_ps(&buildings.extentZ[i]);
+
+		__m256 outside = zero;
+		for (int p = 0; p < 6; p++) {
+			__m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(normalX[p], cx), _mm256_mul_ps(normalY[p], cy)),
+											_mm256_add_ps(_mm256_mul_ps(normalZ[p], cz), offset[p]));
+			__m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(absX[p], ex), _mm256_mul_ps(absY[p], ey)),
+										  _mm256_mul_ps(absZ[p], ez));
+			outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), zero, _CMP_LT_OQ));
+		}
+
+		int visibleMask = ~_mm256_movemask_ps(outside) & 0xFF;
+		for (int lane = 0; visibleMask != 0; lane++, visibleMask >>= 1) {
+			if ((visibleMask & 1) && i + lane < end)
+				visibleBuildings->push_back((unsigned int)(i + lane));
+		}
+	}
+	for (; i < end; i++) {
+		if (isBoxVisible(frustum, buildings.center(i), buildings.extent(i)))
+			visibleBuildings->push_back((unsigned int)i);
+	}
+}
+
+#elif GLM_ARCH & GLM_ARCH_SSE2_BIT
+
+void cullBuildings(const Frustum & frustum, const BuildingTable & buildings, size_t first, size_t count,
+				   std::vector<unsigned int> * visibleBuildings)
+{
+	__m128 normalX[6], normalY[6], normalZ[6], absX[6], absY[6], absZ[6], offset[6];
+	for (int p = 0; p < 6; p++) {
+		const glm::vec4 & plane = frustum.planes[p];
+		normalX[p] = _mm_set1_ps(plane.x);
+		normalY[p] = _mm_set1_ps(plane.y);
+		normalZ[p] = _mm_set1_ps(plane.z);
+		absX[p] = _mm_set1_ps(fabs(plane.x));
+		absY[p] = _mm_set1_ps(fabs(plane.y));
+		absZ[p] = _mm_set1_ps(fabs(plane.z));
+		offset[p] = _mm_set1_ps(plane.w);
+	}
+	const __m128 zero = _mm_setzero_ps();
+
+	// lanes past the end of the range are loaded (the table is padded) but never reported
+	const size_t end = first + count;
+	size_t i = first;
+	for (; i < end && i + 4 <= buildings.paddedCount(); i += 4) {
+		__m128 cx = _mm_loadu_ps(&buildings.centerX[i]);
+		__m128 cy = _mm_loadu_ps(&buildings.centerY[i]);
+		__m128 cz = _mm_loadu_ps(&buildings.centerZ[i]);
+		__m128 ex = _mm_loadu_ps(&buildings.extentX[i]);
+		__m128 ey = _mm_loadu_ps(&buildings.extentY[i]);
+		__m128 ez = _mm_loadu_ps(&buildings.extentZ[i]);
+
+		__m128 outside = zero;
+		for (int p = 0; p < 6; p++) {
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(normalX[p], cx), _mm_mul_ps(normalY[p], cy)),
+										 _mm_add_ps(_mm_mul_ps(normalZ[p], cz), offset[p]));
+			__m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(absX[p], ex), _mm_mul_ps(absY[p], ey)),
+									   _mm_mul_ps(absZ[p], ez));
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), zero));
+		}
+
+		int visibleMask = ~_mm_movemask_ps(outside) & 0xF;
+		for (int lane = 0; visibleMask != 0; lane++, visibleMask >>= 1) {
+			if ((visibleMask & 1) && i + lane < end)
+				visibleBuildings->push_back((unsigned int)(i + lane));
+		}
+	}
+	for (; i < end; i++) {
+		if (isBoxVisible(frustum, buildings.center(i), buildings.extent(i)))
+			visibleBuildings->push_back((unsigned int)i);
+	}
+}
+
+#else
+
+void cullBuildings(const Frustum & frustum, const BuildingTable & buildings, size_t first, size_t count,
+				   std::vector<unsigned int> * visibleBuildings)
+{
+	for (size_t i = first; i < first + count; i++) {
+		if (isBoxVisible(frustum, buildings.center(i), buildings.extent(i)))
+			visibleBuildings->push_back((unsigned int)i);
+	}
+}
+
+#endif
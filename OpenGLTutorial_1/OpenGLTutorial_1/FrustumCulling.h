@@ -0,0 +1,44 @@
+#ifndef FRUSTUM_CULLING_H
+#define FRUSTUM_CULLING_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "BuildingTable.h"
+
+// Six planes (a, b, c, d) of the view volume, a point p is inside when a*p.x + b*p.y + c*p.z + d >= 0
+struct Frustum {
+	glm::vec4 planes[6];	// left, right, bottom, top, near, far
+};
+
+// planes from projection * view matrix (Gribb & Hartmann), once per frame
+Frustum extractFrustum(const glm::mat4 & viewProjection);
+
+// distance from the eye to the far corners of a perspective frustum, the farthest point it sees
+float farCornerDistance(float fovY, float aspect, float farPlane);
+
+// true if the box center +- extent is at least partly inside the frustum
+bool isBoxVisible(const Frustum & frustum, const glm::vec3 & center, const glm::vec3 & extent);
+
+// Where a box lies against the frustum
+enum Frustum_Test {
+	BOX_OUTSIDE,
+	BOX_INTERSECTS,
+	BOX_INSIDE
+};
+
+Frustum_Test classifyBox(const Frustum & frustum, const glm::vec3 & center, const glm::vec3 & extent);
+
+/*
+CULL BUILDINGS
+	test every building of the table against the frustum, 8 (AVX) or 4 (SSE2) boxes at once
+	and append indices of the visible ones to visibleBuildings
+*/
+void cullBuildings(const Frustum & frustum, const BuildingTable & buildings, std::vector<unsigned int> * visibleBuildings);
+
+// the same for buildings <first, first + count) of the table
+void cullBuildings(const Frustum & frustum, const BuildingTable & buildings, size_t first, size_t count,
+				   std::vector<unsigned int> * visibleBuildings);
+
+#endif
@@ -0,0 +1,71 @@
+#include "GL4Functions.h"
+
+#include <cstring>
+
+PFNGLMULTIDRAWELEMENTSINDIRECTPROC glad_glMultiDrawElementsIndirect = NULL;
+PFNGLDRAWARRAYSINDIRECTPROC glad_glDrawArraysIndirect = NULL;
+PFNGLDISPATCHCOMPUTEPROC glad_glDispatchCompute = NULL;
+PFNGLMEMORYBARRIERPROC glad_glMemoryBarrier = NULL;
+PFNGLBINDIMAGETEXTUREPROC glad_glBindImageTexture = NULL;
+PFNGLBUFFERSTORAGEPROC glad_glBufferStorage = NULL;
+
+
+int contextVersion()
+{
+	GLint major = 0, minor = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &major);
+	glGetIntegerv(GL_MINOR_VERSION, &minor);
+	return major * 10 + minor;
+}
+
+bool hasExtension(const char * name)
+{
+	GLint count = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+	for (GLint i = 0; i < count; i++) {
+		const char * extension = (const char *)glGetStringi(GL_EXTENSIONS, i);
+		if (extension != NULL && strcmp(extension, name) == 0)
+			return true;
+	}
+	return false;
+}
+
+
+bool loadMultiDrawIndirect(GLADloadproc load)
+{
+	glad_glMultiDrawElementsIndirect = NULL;
+	if (contextVersion() < 43 && !(hasExtension("GL_ARB_multi_draw_indirect") && hasExtension("GL_ARB_base_instance")))
+		return false;
+	glad_glMultiDrawElementsIndirect = (PFNGLMULTIDRAWELEMENTSINDIRECTPROC)load("glMultiDrawElementsIndirect");
+	return glad_glMultiDrawElementsIndirect != NULL;
+}
+
+bool loadComputeCulling(GLADloadproc load)
+{
+	glad_glDrawArraysIndirect = NULL;
+	glad_glDispatchCompute = NULL;
+	glad_glMemoryBarrier = NULL;
+	glad_glBindImageTexture = NULL;
+	if (contextVersion() < 43)
+		return false;
+	glad_glDrawArraysIndirect = (PFNGLDRAWARRAYSINDIRECTPROC)load("glDrawArraysIndirect");
+	glad_glDispatchCompute = (PFNGLDISPATCHCOMPUTEPROC)load("glDispatchCompute");
+	glad_glMemoryBarrier = (PFNGLMEMORYBARRIERPROC)load("glMemoryBarrier");
+	glad_glBindImageTexture = (PFNGLBINDIMAGETEXTUREPROC)load("glBindImageTexture");
+	return glad_glDrawArraysIndirect != NULL && glad_glDispatchCompute != NULL
+		&& glad_glMemoryBarrier != NULL && glad_glBindImageTexture != NULL;
+}
+
+bool loadBufferStorage(GLADloadproc load)
+{
+	glad_glBufferStorage = NULL;
+	if (contextVersion() < 44 && !hasExtension("GL_ARB_buffer_storage"))
+		return false;
+	glad_glBufferStorage = (PFNGLBUFFERSTORAGEPROC)load("glBufferStorage");
+	return glad_glBufferStorage != NULL;
+}
+
+bool hasPipelineStatistics()
+{
+	return contextVersion() >= 46 || hasExtension("GL_ARB_pipeline_statistics_query");
+}
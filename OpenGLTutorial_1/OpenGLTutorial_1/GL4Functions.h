@@ -0,0 +1,63 @@
+#ifndef GL4_FUNCTIONS_H
+#define GL4_FUNCTIONS_H
+
+#include <glad/glad.h>
+
+/*
+GL 4 FUNCTIONS
+	glad of this project loads only GL 3.3 core, newer entry points used when the driver has them
+	are loaded here by hand (the context is still created as 3.3 core, drivers give the newest version
+	compatible with it), NULL - not available, the caller keeps its GL 3.3 path
+*/
+
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#define GL_COMPUTE_SHADER 0x91B9
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#define GL_TEXTURE_FETCH_BARRIER_BIT 0x00000008
+#define GL_SHADER_IMAGE_ACCESS_BARRIER_BIT 0x00000020
+#define GL_COMMAND_BARRIER_BIT 0x00000040
+#define GL_BUFFER_UPDATE_BARRIER_BIT 0x00000200
+#define GL_SHADER_STORAGE_BARRIER_BIT 0x00002000
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#define GL_VERTEX_SHADER_INVOCATIONS 0x82F0
+#define GL_FRAGMENT_SHADER_INVOCATIONS 0x82F4
+#define GL_CLIPPING_INPUT_PRIMITIVES 0x82F6
+#define GL_CLIPPING_OUTPUT_PRIMITIVES 0x82F7
+
+typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void * indirect, GLsizei drawcount, GLsizei stride);
+GLAPI PFNGLMULTIDRAWELEMENTSINDIRECTPROC glad_glMultiDrawElementsIndirect;
+#define glMultiDrawElementsIndirect glad_glMultiDrawElementsIndirect
+
+typedef void (APIENTRYP PFNGLDRAWARRAYSINDIRECTPROC)(GLenum mode, const void * indirect);
+GLAPI PFNGLDRAWARRAYSINDIRECTPROC glad_glDrawArraysIndirect;
+#define glDrawArraysIndirect glad_glDrawArraysIndirect
+typedef void (APIENTRYP PFNGLDISPATCHCOMPUTEPROC)(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z);
+GLAPI PFNGLDISPATCHCOMPUTEPROC glad_glDispatchCompute;
+#define glDispatchCompute glad_glDispatchCompute
+typedef void (APIENTRYP PFNGLMEMORYBARRIERPROC)(GLbitfield barriers);
+GLAPI PFNGLMEMORYBARRIERPROC glad_glMemoryBarrier;
+#define glMemoryBarrier glad_glMemoryBarrier
+typedef void (APIENTRYP PFNGLBINDIMAGETEXTUREPROC)(GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer, GLenum access, GLenum format);
+GLAPI PFNGLBINDIMAGETEXTUREPROC glad_glBindImageTexture;
+#define glBindImageTexture glad_glBindImageTexture
+
+typedef void (APIENTRYP PFNGLBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void * data, GLbitfield flags);
+GLAPI PFNGLBUFFERSTORAGEPROC glad_glBufferStorage;
+#define glBufferStorage glad_glBufferStorage
+
+// version of the current context, e.g. 43 for 4.3
+int contextVersion();
+// true if the current context has the extension (GL_ARB_...)
+bool hasExtension(const char * name);
+
+// multi-draw indirect with base instance: GL 4.3, or ARB_multi_draw_indirect and ARB_base_instance
+bool loadMultiDrawIndirect(GLADloadproc load);
+// compute shaders, storage buffers, image load/store and glDrawArraysIndirect: GL 4.3
+bool loadComputeCulling(GLADloadproc load);
+// immutable buffer storage, persistent mapping: GL 4.4 or ARB_buffer_storage
+bool loadBufferStorage(GLADloadproc load);
+// pipeline statistics queries, GL_..._SHADER_INVOCATIONS (no entry points): GL 4.6 or ARB_pipeline_statistics_query
+bool hasPipelineStatistics();
+
+#endif
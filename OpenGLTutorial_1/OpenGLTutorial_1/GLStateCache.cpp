@@ -0,0 +1,211 @@
+#include "GLStateCache.h"
+
+#include <cstring>
+
+GLStateCache glState;
+
+
+GLStateCache::GLStateCache()
+	: current(NULL), program(0), vertexArray(0), activeUnit(GL_TEXTURE0), depthFunction(GL_LESS)
+{
+	invalidate();
+	resetCounters();
+}
+
+
+bool GLStateCache::filter(State_Call call, bool same)
+{
+	if (same)
+		filteredCalls[call]++;
+	else
+		madeCalls[call]++;
+	return same;
+}
+
+int GLStateCache::targetSlot(GLenum target)
+{
+	switch (target) {
+	case GL_TEXTURE_2D: return 0;
+	case GL_TEXTURE_CUBE_MAP: return 1;
+	case GL_TEXTURE_BUFFER: return 2;
+	default: return -1;
+	}
+}
+
+
+void GLStateCache::useProgram(GLuint id)
+{
+	if (filter(STATE_PROGRAM, knownProgram && program == id))
+		return;
+	glUseProgram(id);
+	program = id;
+	knownProgram = true;
+	current = id != 0 ? &programs[id] : NULL;
+}
+
+void GLStateCache::bindVertexArray(GLuint VAO)
+{
+	if (filter(STATE_VERTEX_ARRAY, knownVertexArray && vertexArray == VAO))
+		return;
+	glBindVertexArray(VAO);
+	vertexArray = VAO;
+	knownVertexArray = true;
+}
+
+void GLStateCache::activeTexture(GLenum unit)
+{
+	if (filter(STATE_ACTIVE_TEXTURE, knownUnit && activeUnit == unit))
+		return;
+	glActiveTexture(unit);
+	activeUnit = unit;
+	knownUnit = true;
+}
+
+void GLStateCache::bindTexture(GLenum target, GLuint texture)
+{
+	int unit = knownUnit ? (int)(activeUnit - GL_TEXTURE0) : -1;
+	int slot = targetSlot(target);
+	bool cached = unit >= 0 && unit < TEXTURE_UNITS && slot >= 0;
+	if (filter(STATE_TEXTURE, cached && knownTextures[unit][slot] && textures[unit][slot] == texture))
+		return;
+	glBindTexture(target, texture);
+	if (cached) {
+		textures[unit][slot] = texture;
+		knownTextures[unit][slot] = true;
+	}
+}
+
+void GLStateCache::bindTexture(GLenum unit, GLenum target, GLuint texture)
+{
+	int index = (int)(unit - GL_TEXTURE0);
+	int slot = targetSlot(target);
+	if (index >= 0 && index < TEXTURE_UNITS && slot >= 0 && knownTextures[index][slot] && textures[index][slot] == texture) {
+		filteredCalls[STATE_TEXTURE]++;
+		return;
+	}
+	activeTexture(unit);
+	bindTexture(target, texture);
+}
+
+void GLStateCache::depthFunc(GLenum func)
+{
+	if (filter(STATE_DEPTH_FUNC, knownDepthFunc && depthFunction == func))
+		return;
+	glDepthFunc(func);
+	depthFunction = func;
+	knownDepthFunc = true;
+}
+
+
+GLint GLStateCache::uniformLocation(GLuint id, const std::string & name)
+{
+	ProgramState & state = programs[id];
+	std::unordered_map<std::string, GLint>::const_iterator found = state.locations.find(name);
+	if (found != state.locations.end())
+		return found->second;
+	GLint location = glGetUniformLocation(id, name.c_str());
+	state.locations[name] = location;
+	return location;
+}
+
+/*
+UNIFORM VALUES
+	compared byte by byte with the last value set at the location of the current program,
+	a location of -1 (not an active uniform) is ignored by GL, so it is filtered too
+*/
+bool GLStateCache::isSameUniform(GLint location, const void * value, size_t bytes)
+{
+	if (location < 0)
+		return filter(STATE_UNIFORM, true);
+	if (current == NULL || !knownProgram || location >= MAX_CACHED_LOCATION)
+		return filter(STATE_UNIFORM, false);
+	if ((size_t)location >= current->values.size()) {
+		UniformValue unknown = {};
+		current->values.resize(location + 1, unknown);
+	}
+	UniformValue & cached = current->values[location];
+	if (filter(STATE_UNIFORM, cached.known && memcmp(cached.data, value, bytes) == 0))
+		return true;
+	memcpy(cached.data, value, bytes);
+	cached.known = true;
+	return false;
+}
+
+void GLStateCache::uniform1i(GLint location, GLint value)
+{
+	if (!isSameUniform(location, &value, sizeof(GLint)))
+		glUniform1i(location, value);
+}
+
+void GLStateCache::uniform1f(GLint location, GLfloat value)
+{
+	if (!isSameUniform(location, &value, sizeof(GLfloat)))
+		glUniform1f(location, value);
+}
+
+void GLStateCache::uniform2fv(GLint location, const GLfloat * value)
+{
+	if (!isSameUniform(location, value, 2 * sizeof(GLfloat)))
+		glUniform2fv(location, 1, value);
+}
+
+void GLStateCache::uniform3fv(GLint location, const GLfloat * value)
+{
+	if (!isSameUniform(location, value, 3 * sizeof(GLfloat)))
+		glUniform3fv(location, 1, value);
+}
+
+void GLStateCache::uniform4fv(GLint location, const GLfloat * value)
+{
+	if (!isSameUniform(location, value, 4 * sizeof(GLfloat)))
+		glUniform4fv(location, 1, value);
+}
+
+void GLStateCache::uniformMatrix2fv(GLint location, const GLfloat * value)
+{
+	if (!isSameUniform(location, value, 4 * sizeof(GLfloat)))
+		glUniformMatrix2fv(location, 1, GL_FALSE, value);
+}
+
+void GLStateCache::uniformMatrix3fv(GLint location, const GLfloat * value)
+{
+	if (!isSameUniform(location, value, 9 * sizeof(GLfloat)))
+		glUniformMatrix3fv(location, 1, GL_FALSE, value);
+}
+
+void GLStateCache::uniformMatrix4fv(GLint location, const GLfloat * value)
+{
+	if (!isSameUniform(location, value, 16 * sizeof(GLfloat)))
+		glUniformMatrix4fv(location, 1, GL_FALSE, value);
+}
+
+
+void GLStateCache::invalidate()
+{
+	knownProgram = knownVertexArray = knownUnit = knownDepthFunc = false;
+	for (int unit = 0; unit < TEXTURE_UNITS; unit++)
+		for (int slot = 0; slot < 3; slot++)
+			knownTextures[unit][slot] = false;
+}
+
+unsigned long GLStateCache::madeTotal() const
+{
+	unsigned long total = 0;
+	for (int call = 0; call < STATE_CALL_COUNT; call++)
+		total += madeCalls[call];
+	return total;
+}
+
+unsigned long GLStateCache::filteredTotal() const
+{
+	unsigned long total = 0;
+	for (int call = 0; call < STATE_CALL_COUNT; call++)
+		total += filteredCalls[call];
+	return total;
+}
+
+void GLStateCache::resetCounters()
+{
+	for (int call = 0; call < STATE_CALL_COUNT; call++)
+		madeCalls[call] = filteredCalls[call] = 0;
+}
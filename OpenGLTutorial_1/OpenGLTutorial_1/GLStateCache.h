@@ -0,0 +1,99 @@
+#ifndef GL_STATE_CACHE_H
+#define GL_STATE_CACHE_H
+
+#include <glad/glad.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Calls filtered by the cache
+enum State_Call {
+	STATE_PROGRAM,
+	STATE_VERTEX_ARRAY,
+	STATE_ACTIVE_TEXTURE,
+	STATE_TEXTURE,
+	STATE_DEPTH_FUNC,
+	STATE_UNIFORM,
+	STATE_CALL_COUNT
+};
+
+/*
+GL STATE CACHE
+	thin layer between the renderer and glad: remembers the program, VAO, active texture unit, textures
+	bound to every unit, depth function and the value of every uniform of every program, a call that
+	would set what is already set is not sent to the driver
+	uniform locations are looked up once per program and name
+	state changed by raw gl calls (loading, modules drawing at load) is unknown to the cache,
+	invalidate() after them makes the next call of every kind go through
+*/
+class GLStateCache
+{
+public:
+	static const int TEXTURE_UNITS = 16;
+	static const GLint MAX_CACHED_LOCATION = 1024;	// uniforms at higher locations are always set
+
+	GLStateCache();
+
+	void useProgram(GLuint program);
+	void bindVertexArray(GLuint VAO);
+	void activeTexture(GLenum unit);
+	// texture of the active unit (GL_TEXTURE_2D, GL_TEXTURE_CUBE_MAP and GL_TEXTURE_BUFFER are cached)
+	void bindTexture(GLenum target, GLuint texture);
+	// texture of the unit, the active unit is changed only when the binding changes
+	void bindTexture(GLenum unit, GLenum target, GLuint texture);
+	void depthFunc(GLenum func);
+
+	// location of the uniform in the program, -1 if the program has no such (active) uniform
+	GLint uniformLocation(GLuint program, const std::string & name);
+	// values for the current program, as glUniform*
+	void uniform1i(GLint location, GLint value);
+	void uniform1f(GLint location, GLfloat value);
+	void uniform2fv(GLint location, const GLfloat * value);
+	void uniform3fv(GLint location, const GLfloat * value);
+	void uniform4fv(GLint location, const GLfloat * value);
+	void uniformMatrix2fv(GLint location, const GLfloat * value);
+	void uniformMatrix3fv(GLint location, const GLfloat * value);
+	void uniformMatrix4fv(GLint location, const GLfloat * value);
+
+	// bindings are unknown, uniform values stay (they live in the programs)
+	void invalidate();
+
+	// calls sent to the driver and filtered since resetCounters
+	unsigned long made(State_Call call) const { return madeCalls[call]; }
+	unsigned long filtered(State_Call call) const { return filteredCalls[call]; }
+	unsigned long madeTotal() const;
+	unsigned long filteredTotal() const;
+	void resetCounters();
+
+private:
+	struct UniformValue {
+		bool known;
+		GLfloat data[16];	// an int is kept by its bits
+	};
+	struct ProgramState {
+		std::unordered_map<std::string, GLint> locations;
+		std::vector<UniformValue> values;	// by location
+	};
+
+	// true if the uniform of the current program already has the value, else it is remembered
+	bool isSameUniform(GLint location, const void * value, size_t bytes);
+	bool filter(State_Call call, bool same);
+	static int targetSlot(GLenum target);
+
+	std::unordered_map<GLuint, ProgramState> programs;
+	ProgramState * current;		// state of the current program
+	GLuint program, vertexArray;
+	GLenum activeUnit, depthFunction;
+	GLuint textures[TEXTURE_UNITS][3];
+	// false after invalidate until the binding is set again
+	bool knownProgram, knownVertexArray, knownUnit, knownDepthFunc;
+	bool knownTextures[TEXTURE_UNITS][3];
+	unsigned long madeCalls[STATE_CALL_COUNT];
+	unsigned long filteredCalls[STATE_CALL_COUNT];
+};
+
+// the cache of the one GL context of the program
+extern GLStateCache glState;
+
+#endif
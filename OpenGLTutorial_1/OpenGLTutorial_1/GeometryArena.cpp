@@ -0,0 +1,111 @@
+#include "GeometryArena.h"
+
+#include <algorithm>
+#include <chrono>
+
+
+GeometryArena::GeometryArena()
+	: format(VERTEX_FLOAT), VAO(0), VBO(0), EBO(0), meshes(0), vertexPeak(0), indexPeak(0)
+{
+	resetStats();
+}
+
+
+void GeometryArena::create(Vertex_Format vertexFormat, uint32_t vertexCapacity, uint32_t indexCapacity)
+{
+	format = vertexFormat;
+	vertexRanges.reset(vertexCapacity);
+	indexRanges.reset(indexCapacity);
+	meshes = vertexPeak = indexPeak = 0;
+
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &VBO);
+	glGenBuffers(1, &EBO);
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)vertexCapacity * getVertexFormat(format).stride, NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);	// stays bound to the VAO
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)indexCapacity * sizeof(unsigned int), NULL, GL_DYNAMIC_DRAW);
+	setupVertexFormat(format);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void GeometryArena::release()
+{
+	if (VAO != 0) {
+		glDeleteVertexArrays(1, &VAO);
+		glDeleteBuffers(1, &VBO);
+		glDeleteBuffers(1, &EBO);
+	}
+	VAO = VBO = EBO = 0;
+	vertexRanges.reset(0);
+	indexRanges.reset(0);
+	meshes = 0;
+}
+
+
+bool GeometryArena::add(const PackedMesh & mesh, ArenaMesh * arenaMesh)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	OffsetAllocator::Allocation vertices = vertexRanges.allocate((uint32_t)mesh.vertexCount);
+	OffsetAllocator::Allocation indices = indexRanges.allocate((uint32_t)mesh.indices.size());
+	if (mesh.format != format || vertices.offset == OffsetAllocator::NO_SPACE || indices.offset == OffsetAllocator::NO_SPACE) {
+		vertexRanges.free(vertices);
+		indexRanges.free(indices);
+		failedCount++;
+		return false;
+	}
+
+	// the VAO is not needed for the copy, the element buffer binding of another VAO stays untouched
+	const GLsizeiptr stride = getVertexFormat(format).stride;
+	glBindBuffer(GL_COPY_WRITE_BUFFER, VBO);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, vertices.offset * stride, mesh.vertices.size(), mesh.vertices.data());
+	glBindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, indices.offset * sizeof(unsigned int), mesh.indices.size() * sizeof(unsigned int), mesh.indices.data());
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	arenaMesh->vertices = vertices;
+	arenaMesh->indices = indices;
+	arenaMesh->indexCount = (GLsizei)mesh.indices.size();
+	meshes++;
+	vertexPeak = std::max(vertexPeak, vertexRanges.usedSize());
+	indexPeak = std::max(indexPeak, indexRanges.usedSize());
+	allocationCount++;
+	allocationMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	return true;
+}
+
+void GeometryArena::remove(ArenaMesh * arenaMesh)
+{
+	if (arenaMesh->indexCount == 0)
+		return;
+	vertexRanges.free(arenaMesh->vertices);
+	indexRanges.free(arenaMesh->indices);
+	arenaMesh->indexCount = 0;
+	meshes--;
+}
+
+
+void GeometryArena::draw(const ArenaMesh & arenaMesh) const
+{
+	glDrawElementsBaseVertex(GL_TRIANGLES, arenaMesh.indexCount, GL_UNSIGNED_INT,
+							 (void*)(arenaMesh.indices.offset * sizeof(unsigned int)), (GLint)arenaMesh.vertices.offset);
+}
+
+
+float GeometryArena::fragmentation() const
+{
+	return vertexRanges.fragmentation();
+}
+
+size_t GeometryArena::memoryBytes() const
+{
+	return (size_t)vertexRanges.capacity() * getVertexFormat(format).stride + (size_t)indexRanges.capacity() * sizeof(unsigned int);
+}
+
+void GeometryArena::resetStats()
+{
+	allocationCount = failedCount = 0;
+	allocationMs = 0.0;
+}
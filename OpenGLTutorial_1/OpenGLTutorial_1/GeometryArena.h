@@ -0,0 +1,71 @@
+#ifndef GEOMETRY_ARENA_H
+#define GEOMETRY_ARENA_H
+
+#include <glad/glad.h>
+
+#include <stdint.h>
+
+#include "OffsetAllocator.h"
+#include "VertexFormats.h"
+
+// Ranges of a mesh in the arena
+struct ArenaMesh {
+	OffsetAllocator::Allocation vertices;	// offset - base vertex of the indices
+	OffsetAllocator::Allocation indices;	// offset - first index
+	GLsizei indexCount;						// 0 - not in the arena
+
+	ArenaMesh() : indexCount(0) {}
+};
+
+/*
+GEOMETRY ARENA
+	meshes made and dropped while the program runs (per city block) share one vertex and one index buffer
+	created once, instead of a VAO and two buffers each: an OffsetAllocator gives every mesh its ranges,
+	the data is copied there with glBufferSubData, indices stay local to the mesh and are drawn
+	with glDrawElementsBaseVertex, freed ranges merge with their free neighbours
+	all meshes have the vertex format of the arena
+*/
+class GeometryArena
+{
+public:
+	GeometryArena();
+
+	// buffers for this many vertices and indices (needs the GL context)
+	void create(Vertex_Format format, uint32_t vertexCapacity, uint32_t indexCapacity);
+	void release();
+
+	// ranges for the mesh (of the arena's format) and its data copied there, false - no space, nothing allocated
+	bool add(const PackedMesh & mesh, ArenaMesh * arenaMesh);
+	void remove(ArenaMesh * arenaMesh);
+
+	// with the VAO of the arena bound
+	void draw(const ArenaMesh & arenaMesh) const;
+
+	GLuint getVAO() const { return VAO; }
+	Vertex_Format getFormat() const { return format; }
+
+	uint32_t meshCount() const { return meshes; }
+	uint32_t usedVertices() const { return vertexRanges.usedSize(); }
+	uint32_t usedIndices() const { return indexRanges.usedSize(); }
+	uint32_t peakVertices() const { return vertexPeak; }
+	uint32_t peakIndices() const { return indexPeak; }
+	// of the vertex buffer (the bigger of the two), see OffsetAllocator::fragmentation
+	float fragmentation() const;
+	size_t memoryBytes() const;
+
+	// allocations and their CPU time (allocator and copy) since resetStats, failed - arena was full
+	unsigned int allocations() const { return allocationCount; }
+	unsigned int failedAllocations() const { return failedCount; }
+	double allocationMilliseconds() const { return allocationMs; }
+	void resetStats();
+
+private:
+	OffsetAllocator vertexRanges, indexRanges;
+	Vertex_Format format;
+	GLuint VAO, VBO, EBO;
+	uint32_t meshes, vertexPeak, indexPeak;
+	unsigned int allocationCount, failedCount;
+	double allocationMs;
+};
+
+#endif
@@ -0,0 +1,195 @@
+#include "GpuCulling.h"
+
+#include <algorithm>
+#include <string>
+
+#include "FrustumCulling.h"
+
+
+GpuCulling::GpuCulling()
+	: cullShader(NULL), pyramidShader(NULL), VAO(0), buildingBuffer(0), visibleBuffer(0), visibleTexture(0), commandBuffer(0),
+	  depthTexture(0), pyramidTexture(0), buildingCount(0), depthWidth(0), depthHeight(0), pyramidLevels(0), hasPyramid(false)
+{
+	for (int level = 0; level < LEVELS; level++)
+		first[level] = 0;
+	for (int c = 0; c < COMMANDS; c++) {
+		DrawArraysIndirectCommand command = { BuildingPulling::FACE_VERTICES, 0, (GLuint)((c % 3) * BuildingPulling::FACE_VERTICES), 0 };
+		commands[c] = command;
+	}
+}
+
+
+/*
+CREATE
+	records of all buildings grouped by level, the visible records of a level get the same place
+	in their buffer, so a level never overflows into the next one
+*/
+bool GpuCulling::create(const BuildingTable & buildings, const std::vector<glm::vec4> & cubePositions)
+{
+	std::vector<uint32_t> records(buildings.count);
+	GLint counts[LEVELS] = { 0 };
+	for (unsigned int b = 0; b < buildings.count; b++) {
+		records[b] = BuildingPulling::recordOf(b, buildings, cubePositions);
+		counts[records[b] >> 30]++;
+	}
+	GLint total = 0;
+	for (int level = 0; level < LEVELS; level++) {
+		first[level] = total;
+		total += counts[level];
+	}
+	buildingCount = buildings.count;
+
+	cullShader = new Shader("cull_buildings.cs");
+	pyramidShader = new Shader("depth_pyramid.cs");
+	GLint linked = 0, pyramidLinked = 0;
+	glGetProgramiv(cullShader->ID, GL_LINK_STATUS, &linked);
+	glGetProgramiv(pyramidShader->ID, GL_LINK_STATUS, &pyramidLinked);
+
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &buildingBuffer);
+	glGenBuffers(1, &visibleBuffer);
+	glGenBuffers(1, &commandBuffer);
+	glGenTextures(1, &visibleTexture);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, buildingBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, (records.size() + 1) * sizeof(uint32_t), NULL, GL_STATIC_DRAW);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, records.size() * sizeof(uint32_t), records.data());
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, visibleBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, (records.size() + 1) * sizeof(uint32_t), NULL, GL_DYNAMIC_COPY);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, commandBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(commands), commands, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	glBindTexture(GL_TEXTURE_BUFFER, visibleTexture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, visibleBuffer);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+	glGenTextures(1, &depthTexture);
+	glGenTextures(1, &pyramidTexture);
+	return linked && pyramidLinked;
+}
+
+void GpuCulling::release()
+{
+	if (VAO != 0) {
+		glDeleteProgram(cullShader->ID);
+		glDeleteProgram(pyramidShader->ID);
+		glDeleteTextures(1, &visibleTexture);
+		glDeleteTextures(1, &depthTexture);
+		glDeleteTextures(1, &pyramidTexture);
+		glDeleteBuffers(1, &buildingBuffer);
+		glDeleteBuffers(1, &visibleBuffer);
+		glDeleteBuffers(1, &commandBuffer);
+		glDeleteVertexArrays(1, &VAO);
+	}
+	delete cullShader;
+	delete pyramidShader;
+	cullShader = pyramidShader = NULL;
+	VAO = buildingBuffer = visibleBuffer = visibleTexture = commandBuffer = depthTexture = pyramidTexture = 0;
+	hasPyramid = false;
+}
+
+
+void GpuCulling::cull(const glm::mat4 & viewProjection, bool useDepthPyramid)
+{
+	// instance counts back to 0, the appends of this cull start at the first record of their level
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, commandBuffer);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(commands), commands);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	if (buildingCount == 0)
+		return;
+
+	Frustum frustum = extractFrustum(viewProjection);
+	cullShader->use();
+	cullShader->setInt("buildingCount", (int)buildingCount);
+	for (int level = 0; level < LEVELS; level++)
+		cullShader->setInt("firstBuilding[" + std::to_string(level) + "]", first[level]);
+	for (int i = 0; i < 6; i++)
+		cullShader->setVec4("planes[" + std::to_string(i) + "]", frustum.planes[i]);
+	bool occlusion = useDepthPyramid && hasPyramid;
+	cullShader->setBool("useDepthPyramid", occlusion);
+	cullShader->setMat4("pyramidViewProjection", pyramidViewProjection);
+	cullShader->setVec2("depthSize", (float)depthWidth, (float)depthHeight);
+	cullShader->setInt("depthPyramid", 0);
+	glState.bindTexture(GL_TEXTURE0, GL_TEXTURE_2D, occlusion ? pyramidTexture : 0);
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buildingBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, visibleBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, commandBuffer);
+	glDispatchCompute((buildingCount + LOCAL_SIZE - 1) / LOCAL_SIZE, 1, 1);
+	// commands and visible records are read by the draws as indirect commands and a texture buffer,
+	// the instance counts written by the atomics are reset by glBufferSubData of the next cull
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+	glState.bindTexture(GL_TEXTURE0, GL_TEXTURE_2D, 0);
+}
+
+
+void GpuCulling::resizePyramid(int width, int height)
+{
+	depthWidth = width;
+	depthHeight = height;
+	glState.activeTexture(GL_TEXTURE0);
+	glState.bindTexture(GL_TEXTURE_2D, depthTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, width, height, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	glState.activeTexture(GL_TEXTURE0);
+	glState.bindTexture(GL_TEXTURE_2D, pyramidTexture);
+	int levelWidth = std::max(width / 2, 1), levelHeight = std::max(height / 2, 1);
+	for (pyramidLevels = 0; ; pyramidLevels++) {
+		glTexImage2D(GL_TEXTURE_2D, pyramidLevels, GL_R32F, levelWidth, levelHeight, 0, GL_RED, GL_FLOAT, NULL);
+		if (levelWidth == 1 && levelHeight == 1)
+			break;
+		levelWidth = std::max(levelWidth / 2, 1);
+		levelHeight = std::max(levelHeight / 2, 1);
+	}
+	pyramidLevels++;
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, pyramidLevels - 1);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glState.bindTexture(GL_TEXTURE0, GL_TEXTURE_2D, 0);
+}
+
+/*
+DEPTH PYRAMID
+	copy of the depth buffer (the size of the viewport), then one dispatch per level,
+	every level reads the one before it
+*/
+void GpuCulling::buildDepthPyramid(const glm::mat4 & viewProjection)
+{
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	if (viewport[2] < 2 || viewport[3] < 2)
+		return;
+	if (viewport[2] != depthWidth || viewport[3] != depthHeight)
+		resizePyramid(viewport[2], viewport[3]);
+
+	glState.activeTexture(GL_TEXTURE0);
+	glState.bindTexture(GL_TEXTURE_2D, depthTexture);
+	glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, viewport[0], viewport[1], depthWidth, depthHeight);
+
+	pyramidShader->use();
+	pyramidShader->setInt("depth", 0);
+	int levelWidth = std::max(depthWidth / 2, 1), levelHeight = std::max(depthHeight / 2, 1);
+	for (int level = 0; level < pyramidLevels; level++) {
+		pyramidShader->setBool("fromDepth", level == 0);
+		glBindImageTexture(0, pyramidTexture, std::max(level - 1, 0), GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+		glBindImageTexture(1, pyramidTexture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+		glDispatchCompute((levelWidth + PYRAMID_LOCAL_SIZE - 1) / PYRAMID_LOCAL_SIZE,
+						  (levelHeight + PYRAMID_LOCAL_SIZE - 1) / PYRAMID_LOCAL_SIZE, 1);
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+		levelWidth = std::max(levelWidth / 2, 1);
+		levelHeight = std::max(levelHeight / 2, 1);
+	}
+	// the next cull samples the pyramid as a texture
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+	glState.bindTexture(GL_TEXTURE0, GL_TEXTURE_2D, 0);
+	pyramidViewProjection = viewProjection;
+	hasPyramid = true;
+}
+
+
+void GpuCulling::draw(int level, int texture) const
+{
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+	glDrawArraysIndirect(GL_TRIANGLES, (const void *)((level * 3 + texture) * sizeof(DrawArraysIndirectCommand)));
+}
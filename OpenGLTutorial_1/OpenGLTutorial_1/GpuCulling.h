@@ -0,0 +1,83 @@
+#ifndef GPU_CULLING_H
+#define GPU_CULLING_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <stdint.h>
+#include <vector>
+
+#include "BuildingPulling.h"
+#include "BuildingTable.h"
+#include "GL4Functions.h"
+#include "Shader.h"
+
+// record of GL_DRAW_INDIRECT_BUFFER read by glDrawArraysIndirect
+struct DrawArraysIndirectCommand {
+	GLuint count;			// vertices
+	GLuint instanceCount;	// written by cull_buildings.cs
+	GLuint first;
+	GLuint baseInstance;
+};
+
+/*
+GPU CULLING
+	culling of all buildings in a compute shader (cull_buildings.cs), nothing of it runs on the CPU:
+	records of all buildings (BuildingPulling format) stay in a storage buffer, one invocation tests
+	one building against the frustum and, if wanted, the depth pyramid of the last frame, and a visible
+	building is appended to the records of its texture level with atomicAdd on the instance counts
+	of the level's 3 draw commands (one per face pair), so the draws need no read back
+	the visible records are drawn by building_pulling.vs, the CPU submits the same 12 glDrawArraysIndirect
+	for any size of the city
+	depth pyramid: the depth buffer of the finished frame is copied to a texture and reduced (depth_pyramid.cs)
+	to a mip chain where a texel is the farthest depth under it, level 0 is half of the screen;
+	a box is occluded when its nearest depth is behind the 2 x 2 texels of the level covering it,
+	the pyramid is one frame old, so a building appearing from behind a corner is drawn one frame late
+*/
+class GpuCulling
+{
+public:
+	static const int LEVELS = BuildingPulling::LEVELS;
+	static const int COMMANDS = LEVELS * 3;	// level * 3 + face pair
+	static const int LOCAL_SIZE = 64;		// buildings of a work group of cull_buildings.cs
+	static const int PYRAMID_LOCAL_SIZE = 8;	// texels on a side of a work group of depth_pyramid.cs
+
+	GpuCulling();
+
+	// programs and buffers, records of all buildings uploaded once (needs the GL context and loadComputeCulling)
+	bool create(const BuildingTable & buildings, const std::vector<glm::vec4> & cubePositions);
+	void release();
+
+	// visible records and instance counts of the frame, depth pyramid used only when one was built
+	void cull(const glm::mat4 & viewProjection, bool useDepthPyramid);
+	// depth buffer of the finished frame (seen with viewProjection) to the pyramid of the next cull
+	void buildDepthPyramid(const glm::mat4 & viewProjection);
+	// a pyramid of an older frame must not cull (e.g. after the pyramid was switched off)
+	void dropDepthPyramid() { hasPyramid = false; }
+
+	// one face pair of one level, with building_pulling.vs bound on the empty VAO and getTexture
+	void draw(int level, int texture) const;
+
+	GLuint getVAO() const { return VAO; }
+	GLuint getTexture() const { return visibleTexture; }
+	GLint firstBuilding(int level) const { return first[level]; }
+	GLsizei commandCount() const { return COMMANDS; }
+	// bytes sent to the GPU by a cull (the reset of the instance counts)
+	size_t uploadedBytes() const { return sizeof(commands); }
+
+private:
+	void resizePyramid(int width, int height);
+
+	Shader * cullShader;
+	Shader * pyramidShader;
+	GLuint VAO, buildingBuffer, visibleBuffer, visibleTexture, commandBuffer;
+	GLuint depthTexture, pyramidTexture;
+	GLuint buildingCount;
+	GLint first[LEVELS];
+	DrawArraysIndirectCommand commands[COMMANDS];	// instance counts 0, uploaded before each cull
+	int depthWidth, depthHeight, pyramidLevels;
+	bool hasPyramid;
+	glm::mat4 pyramidViewProjection;
+};
+
+#endif
@@ -0,0 +1,106 @@
+#include "HeightMap.h"
+
+#include <cmath>
+#include <cstdlib>
+
+
+void HeightMap::assign(int width, int depth, const HeightCell * first)
+{
+	mapWidth = width;
+	mapDepth = depth;
+	cells.assign(first, first + (size_t)width * depth);
+}
+
+
+/*
+ROOFS
+	one linear pass over the grid, in the same order generateCity creates buildings (z, then x)
+*/
+void HeightMap::roofs(std::vector<glm::vec4> * roofsPositions) const
+{
+	roofsPositions->clear();
+	for (int z = 0; z < mapDepth; z++) {
+		for (int x = 0; x < mapWidth; x++) {
+			const HeightCell & cell = cells[(size_t)z * mapWidth + x];
+			if (cell.height > 0)
+				roofsPositions->push_back(glm::vec4(x - 0.5f, (float)cell.height, z - 0.5f, (float)cell.level));
+		}
+	}
+}
+
+
+/*
+QUERY BATCH
+	same lookup as query, with the bounds of the map checked once as unsigned comparison
+*/
+void HeightMap::queryBatch(const glm::vec3 * positions, size_t count, CellQuery * results) const
+{
+	const HeightCell * grid = cells.data();
+	for (size_t i = 0; i < count; i++) {
+		unsigned int x = (unsigned int)cellX(positions[i].x);
+		unsigned int z = (unsigned int)cellZ(positions[i].z);
+		unsigned char height = 0;
+		if (x < (unsigned int)mapWidth && z < (unsigned int)mapDepth)
+			height = grid[(size_t)z * mapWidth + x].height;
+		results[i].roofHeight = (float)height;
+		results[i].occupied = height > 0;
+	}
+}
+
+
+/*
+SWEEP
+	Amanatides & Woo voxel traversal in grid space, where cell (x, z) spans <x - 0.5, x + 0.5)
+	tMax - value of t at which the segment crosses the next cell boundary on the axis
+	tDelta - how much t grows between two boundaries on the axis
+*/
+bool HeightMap::sweep(const glm::vec3 & from, const glm::vec3 & to, SweepHit * hit) const
+{
+	const glm::vec3 origin(from.x + 0.5f, from.y, from.z + 0.5f);
+	const glm::vec3 delta = to - from;
+	const glm::ivec3 last = glm::ivec3(glm::floor(origin + delta));
+
+	glm::ivec3 cell = glm::ivec3(glm::floor(origin));
+	glm::ivec3 step;
+	glm::vec3 tMax, tDelta;
+	for (int axis = 0; axis < 3; axis++) {
+		if (delta[axis] > 0.0f) {
+			step[axis] = 1;
+			tDelta[axis] = 1.0f / delta[axis];
+			tMax[axis] = (cell[axis] + 1 - origin[axis]) * tDelta[axis];
+		}
+		else if (delta[axis] < 0.0f) {
+			step[axis] = -1;
+			tDelta[axis] = -1.0f / delta[axis];
+			tMax[axis] = (origin[axis] - cell[axis]) * tDelta[axis];
+		}
+		else {
+			step[axis] = 0;
+			tDelta[axis] = tMax[axis] = INFINITY;
+		}
+	}
+
+	float t = 0.0f;
+	glm::vec3 normal(0.0f);
+	int remaining = abs(last.x - cell.x) + abs(last.y - cell.y) + abs(last.z - cell.z);
+	for (;;) {
+		if (contains(cell.x, cell.z) && cell.y < topHeight(cell.x, cell.z)) {
+			hit->t = t;
+			hit->position = from + delta * t;
+			hit->normal = normal;
+			hit->cell = cell;
+			return true;
+		}
+		if (remaining-- <= 0)
+			return false;
+
+		int axis = tMax.x < tMax.y ? (tMax.x < tMax.z ? 0 : 2) : (tMax.y < tMax.z ? 1 : 2);
+		if (tMax[axis] > 1.0f)
+			return false;
+		t = tMax[axis];
+		cell[axis] += step[axis];
+		tMax[axis] += tDelta[axis];
+		normal = glm::vec3(0.0f);
+		normal[axis] = (float)-step[axis];
+	}
+}
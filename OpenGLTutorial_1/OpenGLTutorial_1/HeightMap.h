@@ -0,0 +1,104 @@
+#ifndef HEIGHT_MAP_H
+#define HEIGHT_MAP_H
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <vector>
+
+// One column of the city grid
+struct HeightCell {
+	unsigned char height;	// number of floors, 0 - street or crossing
+	unsigned char level;	// texture level of the building (cubePositions[i].w)
+};
+
+// What stands under a point of the world
+struct CellQuery {
+	float roofHeight;	// y of the roof, 0 for streets and outside of the city
+	bool occupied;		// true if there is a building on the cell
+};
+
+// First solid cell crossed by a swept segment
+struct SweepHit {
+	float t;				// 0 - start of the segment, 1 - end of the segment
+	glm::vec3 position;		// point where the segment enters the cell
+	glm::vec3 normal;		// face of the cell that was entered, (0, 0, 0) if the segment starts inside
+	glm::ivec3 cell;		// (x, floor, z) of the hit cell
+};
+
+/*
+HEIGHT MAP
+	dense 2D grid of the city, one cell per (x, z) position of cubePositions
+	filled by generateCity in the same pass that creates the cubes,
+	so roof data no longer has to be searched for in cubePositions
+*/
+class HeightMap
+{
+public:
+	HeightMap() : mapWidth(0), mapDepth(0) {}
+
+	// clear the map and resize it to width x depth empty cells
+	void reset(int width, int depth)
+	{
+		mapWidth = width;
+		mapDepth = depth;
+		cells.assign((size_t)width * depth, HeightCell());
+	}
+
+	// set the building standing on the cell
+	void setColumn(int x, int z, int height, int level)
+	{
+		HeightCell & cell = cells[(size_t)z * mapWidth + x];
+		cell.height = (unsigned char)height;
+		cell.level = (unsigned char)level;
+	}
+
+	int width() const { return mapWidth; }
+	int depth() const { return mapDepth; }
+	bool contains(int x, int z) const { return x >= 0 && z >= 0 && x < mapWidth && z < mapDepth; }
+
+	// height of the highest floor's roof on the cell, 0 if there is no building
+	int topHeight(int x, int z) const { return cells[(size_t)z * mapWidth + x].height; }
+	int level(int x, int z) const { return cells[(size_t)z * mapWidth + x].level; }
+
+	// cell of the grid containing world position - cubes are centred on integer x, z
+	static int cellX(float x) { return (int)floor(x + 0.5f); }
+	static int cellZ(float z) { return (int)floor(z + 0.5f); }
+
+	// constant time lookup of the building under the position
+	CellQuery query(const glm::vec3 & position) const
+	{
+		CellQuery result = { 0.0f, false };
+		int x = cellX(position.x);
+		int z = cellZ(position.z);
+		if (contains(x, z)) {
+			const HeightCell & cell = cells[(size_t)z * mapWidth + x];
+			result.roofHeight = (float)cell.height;
+			result.occupied = cell.height > 0;
+		}
+		return result;
+	}
+
+	// query for many moving objects at once, results[i] belongs to positions[i]
+	void queryBatch(const glm::vec3 * positions, size_t count, CellQuery * results) const;
+
+	// walk the cells crossed by the segment (3D DDA) and return the first one inside a building
+	// floor i of a building fills y in <i, i + 1), so cost depends only on the number of crossed cells
+	bool sweep(const glm::vec3 & from, const glm::vec3 & to, SweepHit * hit) const;
+
+	const HeightCell * data() const { return cells.data(); }
+	size_t size() const { return cells.size(); }
+
+	// rebuild the map from already stored cells (e.g. a snapshot)
+	void assign(int width, int depth, const HeightCell * first);
+
+	// roofs in the format of the old GetRoofsPositions: (x - 0.5, height, z - 0.5, level) per building
+	void roofs(std::vector<glm::vec4> * roofsPositions) const;
+
+private:
+	int mapWidth;
+	int mapDepth;
+	std::vector<HeightCell> cells;
+};
+
+#endif
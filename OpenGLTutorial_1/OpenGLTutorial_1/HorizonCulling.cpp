@@ -0,0 +1,143 @@
+#include "HorizonCulling.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <utility>
+
+/*
+azimuth as a "diamond angle" in <0, 4) instead of atan2: grows with the angle, so columns keep their order
+(they are just not equally wide), and the opposite direction is always 2 further
+*/
+static float diamondAngle(float x, float z)
+{
+	if (z >= 0.0f)
+		return x >= 0.0f ? z / (x + z) : 1.0f - x / (z - x);
+	return x < 0.0f ? 2.0f - z / (-x - z) : 3.0f + x / (x - z);
+}
+
+static float wrapAngle(float angle)
+{
+	if (angle > 2.0f)
+		return angle - 4.0f;
+	if (angle <= -2.0f)
+		return angle + 4.0f;
+	return angle;
+}
+
+
+HorizonCulling::HorizonCulling()
+	: horizon(COLUMNS, -INFINITY), culledCount(0)
+{
+}
+
+
+bool HorizonCulling::footprint(const glm::vec3 & eye, const glm::vec3 & center, const glm::vec3 & extent, HorizonFootprint * result)
+{
+	glm::vec2 offset(center.x - eye.x, center.z - eye.z);
+	glm::vec2 outside = glm::max(glm::abs(offset) - glm::vec2(extent.x, extent.z), glm::vec2(0.0f));
+	result->nearest = glm::length(outside);
+	if (result->nearest <= 0.0f)
+		return false;
+	result->farthest = glm::length(glm::abs(offset) + glm::vec2(extent.x, extent.z));
+	result->height = center.y + extent.y - eye.y;
+
+	// the eye is outside, so the corners span less than half a turn around the direction to the center
+	float centerAngle = diamondAngle(offset.x, offset.y);
+	float minDelta = 0.0f, maxDelta = 0.0f;
+	for (int corner = 0; corner < 4; corner++) {
+		float x = offset.x + (corner & 1 ? extent.x : -extent.x);
+		float z = offset.y + (corner & 2 ? extent.z : -extent.z);
+		float delta = wrapAngle(diamondAngle(x, z) - centerAngle);
+		minDelta = std::min(minDelta, delta);
+		maxDelta = std::max(maxDelta, delta);
+	}
+	const float columnsPerUnit = COLUMNS / 4.0f;
+	result->firstColumn = (centerAngle + minDelta) * columnsPerUnit;
+	result->lastColumn = (centerAngle + maxDelta) * columnsPerUnit;
+	if (result->firstColumn < 0.0f) {
+		result->firstColumn += COLUMNS;
+		result->lastColumn += COLUMNS;
+	}
+	return true;
+}
+
+
+void HorizonCulling::clear()
+{
+	std::fill(horizon.begin(), horizon.end(), -INFINITY);
+}
+
+
+/*
+highest slope of a building's top is height / nearest (height / farthest when the roof is under the eye),
+the slope an occluder surely hides is height / farthest (height / nearest under the eye)
+*/
+bool HorizonCulling::isHidden(const HorizonFootprint & footprint) const
+{
+	float top = footprint.height / (footprint.height > 0.0f ? footprint.nearest : footprint.farthest);
+	for (int column = (int)floor(footprint.firstColumn); column <= (int)floor(footprint.lastColumn); column++) {
+		if (top > horizon[column % COLUMNS])
+			return false;
+	}
+	return true;
+}
+
+void HorizonCulling::addOccluder(const HorizonFootprint & occluder)
+{
+	float slope = occluder.height / (occluder.height > 0.0f ? occluder.farthest : occluder.nearest);
+	// only columns lying completely inside the occluder
+	for (int column = (int)ceil(occluder.firstColumn); column + 1 <= occluder.lastColumn; column++) {
+		float & value = horizon[column % COLUMNS];
+		value = std::max(value, slope);
+	}
+}
+
+
+/*
+CULL
+	an occluder is added to the horizon only when the next tested building starts farther than all of it,
+	so a building is never hidden by one standing next to it
+*/
+void HorizonCulling::cull(const glm::vec3 & eye, const BuildingTable & buildings, std::vector<unsigned int> * visibleBuildings)
+{
+	clear();
+	culledCount = 0;
+
+	std::vector<unsigned int> & candidates = *visibleBuildings;
+	std::vector<HorizonFootprint> footprints(candidates.size());
+	std::vector<unsigned char> hidden(candidates.size(), 0);
+	std::vector<std::pair<float, unsigned int> > order;
+	order.reserve(candidates.size());
+	for (size_t i = 0; i < candidates.size(); i++) {
+		if (footprint(eye, buildings.center(candidates[i]), buildings.extent(candidates[i]), &footprints[i]))
+			order.push_back(std::make_pair(footprints[i].nearest, (unsigned int)i));
+	}
+	std::sort(order.begin(), order.end());
+
+	// occluders waiting for the tested distance to pass their farthest corner
+	typedef std::pair<float, unsigned int> Pending;
+	std::priority_queue<Pending, std::vector<Pending>, std::greater<Pending> > pending;
+
+	for (size_t k = 0; k < order.size(); k++) {
+		const HorizonFootprint & current = footprints[order[k].second];
+		while (!pending.empty() && pending.top().first <= current.nearest) {
+			addOccluder(footprints[pending.top().second]);
+			pending.pop();
+		}
+
+		if (isHidden(current))
+			hidden[order[k].second] = 1;
+		else
+			pending.push(std::make_pair(current.farthest, order[k].second));
+	}
+
+	size_t kept = 0;
+	for (size_t i = 0; i < candidates.size(); i++) {
+		if (!hidden[i])
+			candidates[kept++] = candidates[i];
+	}
+	culledCount = (unsigned int)(candidates.size() - kept);
+	candidates.resize(kept);
+}
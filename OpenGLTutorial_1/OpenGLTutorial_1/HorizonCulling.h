@@ -0,0 +1,57 @@
+#ifndef HORIZON_CULLING_H
+#define HORIZON_CULLING_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "BuildingTable.h"
+
+// Footprint of a building as seen from the eye in the ground plane
+struct HorizonFootprint {
+	float nearest;		// distance to the closest point of the footprint
+	float farthest;		// distance to the farthest corner
+	float firstColumn;	// azimuth range in columns, firstColumn <= lastColumn, may go past COLUMNS
+	float lastColumn;
+	float height;		// top of the building over the eye
+};
+
+/*
+HORIZON CULLING
+	the city is a height field (columns of cubes standing on the ground), so visibility can be decided in 2D:
+	directions around the camera are split into COLUMNS azimuth columns, each keeps the highest slope
+	(height over distance) under which everything is already hidden
+	buildings are visited from the nearest, one is culled when its top stays under the horizon in all its columns,
+	otherwise it raises the horizon of the columns it covers completely
+*/
+class HorizonCulling
+{
+public:
+	static const int COLUMNS = 1024;
+
+	HorizonCulling();
+
+	// footprint of the box seen from the eye, false if the eye stands above it
+	static bool footprint(const glm::vec3 & eye, const glm::vec3 & center, const glm::vec3 & extent, HorizonFootprint * result);
+
+	// building passes have to visit footprints by their nearest distance and add an occluder
+	// only when the tested distance is past its farthest corner
+	void clear();
+	bool isHidden(const HorizonFootprint & footprint) const;
+	void addOccluder(const HorizonFootprint & occluder);
+
+	// remove buildings hidden behind nearer ones from visibleBuildings, order of the rest is kept
+	void cull(const glm::vec3 & eye, const BuildingTable & buildings, std::vector<unsigned int> * visibleBuildings);
+
+	// statistics of the last cull
+	unsigned int culled() const { return culledCount; }
+
+	// slope of the horizon in the column (-infinity where nothing stands)
+	float horizonAt(int column) const { return horizon[column]; }
+
+private:
+	std::vector<float> horizon;
+	unsigned int culledCount;
+};
+
+#endif
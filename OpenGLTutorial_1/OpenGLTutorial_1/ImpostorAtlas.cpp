@@ -0,0 +1,146 @@
+#include "ImpostorAtlas.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+static_assert(ImpostorInstance::stride == ImpostorAtlas::INSTANCE_FLOATS * sizeof(float), "instance layout has to match addInstance");
+
+
+ImpostorAtlas::ImpostorAtlas()
+	: tilesPerSide(0), texture(0), captureMs(0.0)
+{
+}
+
+
+void ImpostorAtlas::collect(const BuildingTable & buildings, const std::vector<glm::vec4> & cubePositions)
+{
+	archetypes.clear();
+	buildingArchetype.assign(buildings.count, 0);
+	for (unsigned int b = 0; b < buildings.count; b++) {
+		ImpostorArchetype archetype = { (int)buildings.cubeCount[b], (int)cubePositions[buildings.firstCube[b]].w };
+		unsigned int index = 0;
+		while (index < archetypes.size() && (archetypes[index].height != archetype.height || archetypes[index].level != archetype.level))
+			index++;
+		if (index == archetypes.size())
+			archetypes.push_back(archetype);
+		buildingArchetype[b] = index;
+	}
+	tilesPerSide = 1;
+	while (tilesPerSide * tilesPerSide < (int)archetypes.size())
+		tilesPerSide++;
+}
+
+
+glm::vec2 ImpostorAtlas::encodeDirection(const glm::vec3 & direction)
+{
+	glm::vec3 d(direction.x, std::max(direction.y, 0.0f), direction.z);
+	glm::vec2 p = glm::vec2(d.x, d.z) / (std::abs(d.x) + std::abs(d.y) + std::abs(d.z));
+	return glm::vec2(p.x + p.y, p.x - p.y) * 0.5f + 0.5f;
+}
+
+glm::vec3 ImpostorAtlas::decodeDirection(const glm::vec2 & position)
+{
+	glm::vec2 square = position * 2.0f - 1.0f;
+	glm::vec2 p = glm::vec2(square.x + square.y, square.x - square.y) * 0.5f;
+	return glm::normalize(glm::vec3(p.x, 1.0f - std::abs(p.x) - std::abs(p.y), p.y));
+}
+
+float ImpostorAtlas::radiusOf(const ImpostorArchetype & archetype)
+{
+	return glm::length(glm::vec3(0.5f, archetype.height * 0.5f, 0.5f));
+}
+
+
+/*
+CAPTURE
+	one framebuffer over the whole atlas, every view gets its own viewport, so one clear is enough
+*/
+bool ImpostorAtlas::capture(const DrawArchetype & draw)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	release();
+	const int size = tilesPerSide * FRAMES * FRAME_PIXELS;
+
+	GLint oldViewport[4];
+	glGetIntegerv(GL_VIEWPORT, oldViewport);
+
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	GLuint framebuffer, depthBuffer;
+	glGenFramebuffers(1, &framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+	glGenRenderbuffers(1, &depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, size, size);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+
+	bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+	if (!complete)
+		std::cout << "Impostor atlas framebuffer is not complete" << std::endl;
+	else {
+		glViewport(0, 0, size, size);
+		glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		for (size_t a = 0; a < archetypes.size(); a++) {
+			const int tileX = (int)a % tilesPerSide, tileY = (int)a / tilesPerSide;
+			const float radius = radiusOf(archetypes[a]);
+			const glm::vec3 center(0.0f, (archetypes[a].height - 1) * 0.5f, 0.0f);
+			const glm::mat4 projection = glm::ortho(-radius, radius, -radius, radius, radius, 3.0f * radius);
+			for (int j = 0; j < FRAMES; j++) {
+				for (int i = 0; i < FRAMES; i++) {
+					glm::vec3 direction = decodeDirection((glm::vec2((float)i, (float)j) + 0.5f) / (float)FRAMES);
+					glm::vec3 eye = center + direction * (2.0f * radius);
+					glViewport((tileX * FRAMES + i) * FRAME_PIXELS, (tileY * FRAMES + j) * FRAME_PIXELS, FRAME_PIXELS, FRAME_PIXELS);
+					draw(archetypes[a], eye, glm::lookAt(eye, center, glm::vec3(0.0f, 1.0f, 0.0f)), projection);
+				}
+			}
+		}
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glDeleteRenderbuffers(1, &depthBuffer);
+	glDeleteFramebuffers(1, &framebuffer);
+	glViewport(oldViewport[0], oldViewport[1], oldViewport[2], oldViewport[3]);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glGenerateMipmap(GL_TEXTURE_2D);
+
+	glFinish();
+	captureMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	return complete;
+}
+
+void ImpostorAtlas::release()
+{
+	if (texture != 0)
+		glDeleteTextures(1, &texture);
+	texture = 0;
+}
+
+
+void ImpostorAtlas::addInstance(unsigned int building, const BuildingTable & buildings, std::vector<float> * instances) const
+{
+	unsigned int archetype = buildingArchetype[building];
+	const float instance[INSTANCE_FLOATS] = { buildings.centerX[building], buildings.centerY[building], buildings.centerZ[building],
+											  radiusOf(archetypes[archetype]), (float)archetype };
+	instances->insert(instances->end(), instance, instance + INSTANCE_FLOATS);
+}
+
+
+// RGBA with the mipmap chain (about a third more)
+size_t ImpostorAtlas::memoryBytes() const
+{
+	size_t size = tilesPerSide * FRAMES * FRAME_PIXELS;
+	return size * size * 4 * 4 / 3;
+}
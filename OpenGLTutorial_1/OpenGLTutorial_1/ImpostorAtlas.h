@@ -0,0 +1,80 @@
+#ifndef IMPOSTOR_ATLAS_H
+#define IMPOSTOR_ATLAS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <functional>
+#include <vector>
+
+#include "BuildingTable.h"
+#include "VertexLayout.h"
+
+// blocks smaller than this on screen (CityLod::screenSize) are drawn as impostors, one quad per building
+const float IMPOSTOR_PIXELS = 120.0f;
+
+// One building shape, all buildings with the same floors and texture level look the same
+struct ImpostorArchetype {
+	int height;		// floors
+	int level;		// texture number of cubePositions
+};
+
+// attributes of impostor.vs: corner of the quad, per instance the bounding sphere and the tile
+typedef VertexLayout<VertexAttribute<0, 2, GL_FLOAT, GL_FALSE, 8> > ImpostorCorner;
+typedef VertexLayout<VertexAttribute<1, 4, GL_FLOAT, GL_FALSE, 16>, VertexAttribute<2, 1, GL_FLOAT, GL_FALSE, 4> > ImpostorInstance;
+
+/*
+IMPOSTOR ATLAS
+	every archetype is rendered once at startup from FRAMES x FRAMES directions of the upper hemisphere
+	(hemi-octahedral map: the hemisphere folded into a square, Ryan Brucks' octahedral impostors),
+	each view is an orthographic picture of the bounding sphere into its own FRAME_PIXELS square of the atlas
+	impostor.vs picks the view nearest to the direction of the camera and turns the quad to face
+	the camera of that view, so the picture fits the quad
+	archetypes are tiles of the atlas, tilesPerSide x tilesPerSide of them
+*/
+class ImpostorAtlas
+{
+public:
+	static const int FRAMES = 8;
+	static const int FRAME_PIXELS = 32;
+	// floats of one instance: center, radius of the bounding sphere, tile
+	static const int INSTANCE_FLOATS = 5;
+
+	// draws the archetype standing on the origin (floors at y = 0 .. height - 1), seen from eye
+	typedef std::function<void(const ImpostorArchetype & archetype, const glm::vec3 & eye,
+							   const glm::mat4 & view, const glm::mat4 & projection)> DrawArchetype;
+
+	ImpostorAtlas();
+
+	// distinct archetypes of the city, buildings have to be in their final order
+	void collect(const BuildingTable & buildings, const std::vector<glm::vec4> & cubePositions);
+
+	// render all views into the atlas texture (needs the GL context), false if the framebuffer can't be made
+	bool capture(const DrawArchetype & draw);
+	void release();
+
+	// upper hemisphere <-> unit square, both ways the same as in impostor.vs
+	static glm::vec2 encodeDirection(const glm::vec3 & direction);
+	static glm::vec3 decodeDirection(const glm::vec2 & position);
+
+	void addInstance(unsigned int building, const BuildingTable & buildings, std::vector<float> * instances) const;
+
+	GLuint getTexture() const { return texture; }
+	int getTilesPerSide() const { return tilesPerSide; }
+	const std::vector<ImpostorArchetype> & getArchetypes() const { return archetypes; }
+
+	// statistics of the capture
+	double captureMilliseconds() const { return captureMs; }
+	size_t memoryBytes() const;
+
+private:
+	static float radiusOf(const ImpostorArchetype & archetype);
+
+	std::vector<ImpostorArchetype> archetypes;
+	std::vector<unsigned int> buildingArchetype;
+	int tilesPerSide;
+	GLuint texture;
+	double captureMs;
+};
+
+#endif
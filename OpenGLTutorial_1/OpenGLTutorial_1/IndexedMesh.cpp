@@ -0,0 +1,325 @@
+#include "IndexedMesh.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <unordered_map>
+
+#include <glm/glm.hpp>
+
+// parameters of the score function from Forsyth's article
+static const int FORSYTH_CACHE_SIZE = 32;
+static const float CACHE_DECAY_POWER = 1.5f;
+static const float LAST_TRIANGLE_SCORE = 0.75f;
+static const float VALENCE_BOOST_SCALE = 2.0f;
+static const float VALENCE_BOOST_POWER = 0.5f;
+static const unsigned int NO_TRIANGLE = UINT_MAX;
+
+
+void buildIndexedMesh(const float * vertices, size_t vertexCount, unsigned int floatsPerVertex,
+					  const std::vector<unsigned int> & groupTriangles, IndexedMesh * mesh, MeshStats * stats)
+{
+	weldVertices(vertices, vertexCount, floatsPerVertex, mesh);
+	float acmrWelded = averageCacheMissRatio(mesh->indices);
+	optimizeVertexCache(&mesh->indices, mesh->vertexCount(), groupTriangles);
+	optimizeVertexFetch(mesh);
+
+	if (stats != NULL) {
+		std::vector<unsigned int> list(vertexCount);
+		std::iota(list.begin(), list.end(), 0u);
+		stats->inputVertices = vertexCount;
+		stats->uniqueVertices = mesh->vertexCount();
+		stats->acmrInput = averageCacheMissRatio(list);
+		stats->acmrWelded = acmrWelded;
+		stats->acmrOptimized = averageCacheMissRatio(mesh->indices);
+	}
+}
+
+
+/*
+WELD
+	vertices sorted by their bytes, runs of equal ones get one index
+*/
+void weldVertices(const float * vertices, size_t vertexCount, unsigned int floatsPerVertex, IndexedMesh * mesh)
+{
+	const size_t rowBytes = floatsPerVertex * sizeof(float);
+	std::vector<unsigned int> order(vertexCount);
+	std::iota(order.begin(), order.end(), 0u);
+	std::sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b) {
+		return memcmp(vertices + (size_t)a * floatsPerVertex, vertices + (size_t)b * floatsPerVertex, rowBytes) < 0;
+	});
+
+	mesh->floatsPerVertex = floatsPerVertex;
+	mesh->vertices.clear();
+	mesh->indices.resize(vertexCount);
+	unsigned int unique = 0;
+	for (size_t i = 0; i < vertexCount; i++) {
+		const float * vertex = vertices + (size_t)order[i] * floatsPerVertex;
+		if (i == 0 || memcmp(vertex, vertices + (size_t)order[i - 1] * floatsPerVertex, rowBytes) != 0) {
+			mesh->vertices.insert(mesh->vertices.end(), vertex, vertex + floatsPerVertex);
+			unique++;
+		}
+		mesh->indices[order[i]] = unique - 1;
+	}
+}
+
+
+/*
+vertices recently used get a higher score (the last triangle's ones a fixed one, so the next triangle
+doesn't just repeat them), vertices with few triangles left get a boost, so they are finished and leave
+*/
+static float vertexScore(int cachePosition, unsigned int remainingTriangles)
+{
+	if (remainingTriangles == 0)
+		return -1.0f;
+	float score = 0.0f;
+	if (cachePosition >= 0) {
+		if (cachePosition < 3)
+			score = LAST_TRIANGLE_SCORE;
+		else
+			score = pow(1.0f - (cachePosition - 3) / (float)(FORSYTH_CACHE_SIZE - 3), CACHE_DECAY_POWER);
+	}
+	return score + VALENCE_BOOST_SCALE * pow((float)remainingTriangles, -VALENCE_BOOST_POWER);
+}
+
+/*
+VERTEX CACHE
+	greedy: always emit the triangle with the highest sum of vertex scores, only triangles of the vertices
+	in the modelled cache are rescored after a step, the whole group is searched only when none of them is left
+*/
+void optimizeVertexCache(std::vector<unsigned int> * indices, size_t vertexCount, const std::vector<unsigned int> & groupTriangles)
+{
+	const std::vector<unsigned int> & input = *indices;
+	const size_t triangleCount = input.size() / 3;
+
+	// triangles of every vertex: adjacency[adjacencyOffset[v] .. adjacencyOffset[v + 1])
+	std::vector<unsigned int> adjacencyOffset(vertexCount + 1, 0);
+	for (size_t i = 0; i < triangleCount * 3; i++)
+		adjacencyOffset[input[i] + 1]++;
+	for (size_t v = 0; v < vertexCount; v++)
+		adjacencyOffset[v + 1] += adjacencyOffset[v];
+	std::vector<unsigned int> adjacency(triangleCount * 3);
+	std::vector<unsigned int> cursor(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+	for (size_t i = 0; i < triangleCount * 3; i++)
+		adjacency[cursor[input[i]]++] = (unsigned int)(i / 3);
+
+	std::vector<unsigned int> remaining(vertexCount, 0);
+	std::vector<int> cachePosition(vertexCount, -1);
+	std::vector<float> vertexScores(vertexCount, 0.0f);
+	std::vector<float> triangleScores(triangleCount, 0.0f);
+	std::vector<unsigned char> emitted(triangleCount, 0);
+	std::vector<unsigned int> output;
+	output.reserve(triangleCount * 3);
+	std::vector<unsigned int> cache, newCache;
+
+	size_t groupCount = groupTriangles.empty() ? 1 : groupTriangles.size();
+	size_t first = 0;
+	for (size_t g = 0; g < groupCount && first < triangleCount; g++) {
+		const size_t end = std::min(triangleCount, first + (groupTriangles.empty() ? triangleCount : groupTriangles[g]));
+
+		for (size_t t = first; t < end; t++)
+			for (int k = 0; k < 3; k++)
+				remaining[input[t * 3 + k]]++;
+		for (size_t t = first; t < end; t++)
+			for (int k = 0; k < 3; k++)
+				vertexScores[input[t * 3 + k]] = vertexScore(-1, remaining[input[t * 3 + k]]);
+		for (size_t t = first; t < end; t++)
+			triangleScores[t] = vertexScores[input[t * 3]] + vertexScores[input[t * 3 + 1]] + vertexScores[input[t * 3 + 2]];
+
+		cache.clear();
+		unsigned int best = NO_TRIANGLE;
+		for (size_t n = first; n < end; n++) {
+			if (best == NO_TRIANGLE) {
+				float bestScore = -INFINITY;
+				for (size_t t = first; t < end; t++) {
+					if (!emitted[t] && triangleScores[t] > bestScore) {
+						bestScore = triangleScores[t];
+						best = (unsigned int)t;
+					}
+				}
+			}
+
+			emitted[best] = 1;
+			newCache.clear();
+			for (int k = 0; k < 3; k++) {
+				unsigned int v = input[best * 3 + k];
+				output.push_back(v);
+				remaining[v]--;
+				if (std::find(newCache.begin(), newCache.end(), v) == newCache.end())
+					newCache.push_back(v);
+			}
+			const size_t triangleVertices = newCache.size();
+			for (size_t i = 0; i < cache.size(); i++) {
+				if (std::find(newCache.begin(), newCache.begin() + triangleVertices, cache[i]) == newCache.begin() + triangleVertices)
+					newCache.push_back(cache[i]);
+			}
+
+			// new positions (evicted vertices get -1) and scores of the touched triangles
+			for (size_t i = 0; i < newCache.size(); i++) {
+				unsigned int v = newCache[i];
+				cachePosition[v] = i < (size_t)FORSYTH_CACHE_SIZE ? (int)i : -1;
+				float score = vertexScore(cachePosition[v], remaining[v]);
+				float delta = score - vertexScores[v];
+				vertexScores[v] = score;
+				for (unsigned int a = adjacencyOffset[v]; a < adjacencyOffset[v + 1]; a++)
+					triangleScores[adjacency[a]] += delta;
+			}
+			if (newCache.size() > (size_t)FORSYTH_CACHE_SIZE)
+				newCache.resize(FORSYTH_CACHE_SIZE);
+			cache.swap(newCache);
+
+			best = NO_TRIANGLE;
+			float bestScore = -INFINITY;
+			for (size_t i = 0; i < cache.size(); i++) {
+				unsigned int v = cache[i];
+				for (unsigned int a = adjacencyOffset[v]; a < adjacencyOffset[v + 1]; a++) {
+					unsigned int t = adjacency[a];
+					if (t >= first && t < end && !emitted[t] && triangleScores[t] > bestScore) {
+						bestScore = triangleScores[t];
+						best = t;
+					}
+				}
+			}
+		}
+
+		for (size_t i = 0; i < cache.size(); i++)
+			cachePosition[cache[i]] = -1;
+		first = end;
+	}
+
+	indices->swap(output);
+}
+
+
+/*
+FETCH
+	vertices renumbered in the order the index buffer first uses them
+*/
+void optimizeVertexFetch(IndexedMesh * mesh)
+{
+	const unsigned int size = mesh->floatsPerVertex;
+	std::vector<unsigned int> remap(mesh->vertexCount(), UINT_MAX);
+	std::vector<float> vertices;
+	vertices.reserve(mesh->vertices.size());
+	unsigned int next = 0;
+	for (size_t i = 0; i < mesh->indices.size(); i++) {
+		unsigned int & index = mesh->indices[i];
+		if (remap[index] == UINT_MAX) {
+			remap[index] = next++;
+			vertices.insert(vertices.end(), mesh->vertices.begin() + (size_t)index * size, mesh->vertices.begin() + (size_t)(index + 1) * size);
+		}
+		index = remap[index];
+	}
+	mesh->vertices.swap(vertices);
+}
+
+void extractSubMesh(const IndexedMesh & mesh, size_t firstIndex, size_t indexCount, IndexedMesh * part)
+{
+	const unsigned int size = mesh.floatsPerVertex;
+	std::unordered_map<unsigned int, unsigned int> remap;
+	part->floatsPerVertex = size;
+	part->vertices.clear();
+	part->indices.resize(indexCount);
+	for (size_t i = 0; i < indexCount; i++) {
+		unsigned int index = mesh.indices[firstIndex + i];
+		std::unordered_map<unsigned int, unsigned int>::iterator found = remap.find(index);
+		if (found == remap.end()) {
+			found = remap.insert(std::make_pair(index, (unsigned int)remap.size())).first;
+			part->vertices.insert(part->vertices.end(), mesh.vertices.begin() + (size_t)index * size, mesh.vertices.begin() + (size_t)(index + 1) * size);
+		}
+		part->indices[i] = found->second;
+	}
+}
+
+
+
+// cosine between the face normal and the reference under which a triangle is undecided
+static const float WINDING_MIN_COSINE = 0.5f;
+
+// -1 wrong, 0 undecided, 1 right
+static int triangleWinding(const IndexedMesh & mesh, size_t triangle, Winding_Reference reference, const glm::vec3 & center)
+{
+	const unsigned int size = mesh.floatsPerVertex;
+	glm::vec3 corners[3], normal(0.0f);
+	for (int i = 0; i < 3; i++) {
+		const float * vertex = &mesh.vertices[(size_t)mesh.indices[triangle * 3 + i] * size];
+		corners[i] = glm::vec3(vertex[0], vertex[1], vertex[2]);
+		if (size >= 6)
+			normal += glm::vec3(vertex[3], vertex[4], vertex[5]);
+	}
+	glm::vec3 face = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+	glm::vec3 side = normal;
+	if (reference != WINDING_NORMALS) {
+		side = (corners[0] + corners[1] + corners[2]) / 3.0f - center;
+		if (reference == WINDING_INWARD)
+			side = -side;
+	}
+	float lengths = glm::length(face) * glm::length(side);
+	if (lengths <= 0.0f)
+		return 0;
+	float cosine = glm::dot(face, side) / lengths;
+	if (std::fabs(cosine) < WINDING_MIN_COSINE)
+		return 0;
+	return cosine > 0.0f ? 1 : -1;
+}
+
+static glm::vec3 boundsCenter(const IndexedMesh & mesh)
+{
+	glm::vec3 low(INFINITY), high(-INFINITY);
+	for (size_t v = 0; v < mesh.vertexCount(); v++) {
+		glm::vec3 position(mesh.vertices[v * mesh.floatsPerVertex], mesh.vertices[v * mesh.floatsPerVertex + 1],
+						   mesh.vertices[v * mesh.floatsPerVertex + 2]);
+		low = glm::min(low, position);
+		high = glm::max(high, position);
+	}
+	return (low + high) * 0.5f;
+}
+
+WindingReport checkWinding(const IndexedMesh & mesh, Winding_Reference reference)
+{
+	WindingReport report = { mesh.indices.size() / 3, 0, 0 };
+	if (mesh.floatsPerVertex < 3 || (reference == WINDING_NORMALS && mesh.floatsPerVertex < 6)) {
+		report.undecided = report.triangles;
+		return report;
+	}
+	glm::vec3 center = reference == WINDING_NORMALS ? glm::vec3(0.0f) : boundsCenter(mesh);
+	for (size_t t = 0; t < report.triangles; t++) {
+		int winding = triangleWinding(mesh, t, reference, center);
+		if (winding < 0)
+			report.wrong++;
+		else if (winding == 0)
+			report.undecided++;
+	}
+	return report;
+}
+
+WindingReport fixWinding(IndexedMesh * mesh, Winding_Reference reference)
+{
+	WindingReport report = checkWinding(*mesh, reference);
+	if (report.wrong == 0)
+		return report;
+	glm::vec3 center = reference == WINDING_NORMALS ? glm::vec3(0.0f) : boundsCenter(*mesh);
+	for (size_t t = 0; t < report.triangles; t++)
+		if (triangleWinding(*mesh, t, reference, center) < 0)
+			std::swap(mesh->indices[t * 3 + 1], mesh->indices[t * 3 + 2]);
+	return report;
+}
+
+
+float averageCacheMissRatio(const std::vector<unsigned int> & indices, unsigned int cacheSize)
+{
+	if (indices.size() < 3)
+		return 0.0f;
+	std::vector<unsigned int> cache(cacheSize, UINT_MAX);
+	size_t head = 0, misses = 0;
+	for (size_t i = 0; i < indices.size(); i++) {
+		if (std::find(cache.begin(), cache.end(), indices[i]) == cache.end()) {
+			cache[head] = indices[i];
+			head = (head + 1) % cacheSize;
+			misses++;
+		}
+	}
+	return (float)misses / (indices.size() / 3);
+}
@@ -0,0 +1,74 @@
+#ifndef INDEXED_MESH_H
+#define INDEXED_MESH_H
+
+#include <cstddef>
+#include <vector>
+
+// post-transform vertex cache simulated for the statistics (FIFO, the size of older GPUs)
+const unsigned int VERTEX_CACHE_SIZE = 16;
+
+// Triangle list with shared vertices
+struct IndexedMesh {
+	std::vector<float> vertices;		// floatsPerVertex floats per vertex
+	std::vector<unsigned int> indices;	// 3 per triangle
+	unsigned int floatsPerVertex;
+
+	IndexedMesh() : floatsPerVertex(0) {}
+	size_t vertexCount() const { return floatsPerVertex > 0 ? vertices.size() / floatsPerVertex : 0; }
+};
+
+// What buildIndexedMesh did, ACMR - average cache miss ratio (vertices transformed per triangle, 0.5 - 3)
+struct MeshStats {
+	size_t inputVertices;		// of the triangle list
+	size_t uniqueVertices;
+	float acmrInput;			// triangle list, every vertex transformed for every triangle
+	float acmrWelded;			// indexed in the original triangle order
+	float acmrOptimized;		// indexed after the vertex cache optimization
+};
+
+/*
+MESH BUILDER
+	turns a triangle list (every triangle with its own 3 vertices) into an indexed mesh:
+		weld	- bitwise equal vertices become one
+		cache	- triangles reordered for the post-transform vertex cache
+				  (Tom Forsyth, "Linear-Speed Vertex Cache Optimisation", 2006)
+		fetch	- vertices renumbered in the order of first use, so they are read from memory in order
+	triangles are reordered only inside their group (groupTriangles - triangles of consecutive groups,
+	empty - one group), so ranges drawn with different textures stay where they were
+*/
+void buildIndexedMesh(const float * vertices, size_t vertexCount, unsigned int floatsPerVertex,
+					  const std::vector<unsigned int> & groupTriangles, IndexedMesh * mesh, MeshStats * stats = NULL);
+
+void weldVertices(const float * vertices, size_t vertexCount, unsigned int floatsPerVertex, IndexedMesh * mesh);
+void optimizeVertexCache(std::vector<unsigned int> * indices, size_t vertexCount, const std::vector<unsigned int> & groupTriangles);
+void optimizeVertexFetch(IndexedMesh * mesh);
+
+// triangles <firstIndex, firstIndex + indexCount) of the mesh as a mesh of their own (vertices in the order of first use)
+void extractSubMesh(const IndexedMesh & mesh, size_t firstIndex, size_t indexCount, IndexedMesh * part);
+
+// Which side of a triangle is its front, seen from there the triangle is counter-clockwise (glFrontFace(GL_CCW))
+enum Winding_Reference {
+	WINDING_NORMALS,	// the side of the stored normals (floats 3 - 5 of a vertex)
+	WINDING_OUTWARD,	// away from the center of the mesh's bounds (closed meshes seen from outside)
+	WINDING_INWARD		// toward the center (skybox, seen from inside)
+};
+
+// What checkWinding found
+struct WindingReport {
+	size_t triangles;
+	size_t wrong;		// clockwise seen from the front side
+	size_t undecided;	// degenerate, or the reference lies (nearly) in the plane of the triangle
+};
+
+/*
+WINDING
+	the face normal of every triangle (cross product of two edges) is compared with the reference side,
+	back-face culling can be turned on only when no triangle is wrong
+	fixWinding swaps the 2nd and 3rd index of the wrong triangles and reports what it found before
+*/
+WindingReport checkWinding(const IndexedMesh & mesh, Winding_Reference reference);
+WindingReport fixWinding(IndexedMesh * mesh, Winding_Reference reference);
+
+float averageCacheMissRatio(const std::vector<unsigned int> & indices, unsigned int cacheSize = VERTEX_CACHE_SIZE);
+
+#endif
@@ -0,0 +1,104 @@
+#include "IndirectDraws.h"
+
+
+IndirectDraws::IndirectDraws()
+	: objects(0), commandBuffer(0), instanceBuffer(0)
+{
+}
+
+
+void IndirectDraws::create()
+{
+	glGenBuffers(1, &commandBuffer);
+	glGenBuffers(1, &instanceBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec4), NULL, GL_STREAM_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void IndirectDraws::release()
+{
+	if (commandBuffer != 0) {
+		glDeleteBuffers(1, &commandBuffer);
+		glDeleteBuffers(1, &instanceBuffer);
+	}
+	commandBuffer = instanceBuffer = 0;
+}
+
+void IndirectDraws::attach(GLuint VAO) const
+{
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+	DrawInstance::setup(1);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+
+void IndirectDraws::clear(int materialCount)
+{
+	commands.resize(materialCount);
+	instances.resize(materialCount);
+	for (int m = 0; m < materialCount; m++) {
+		commands[m].clear();
+		instances[m].clear();
+	}
+	objects = 0;
+}
+
+void IndirectDraws::add(int material, GLuint firstIndex, GLuint count, const glm::vec4 & instance)
+{
+	std::vector<DrawElementsIndirectCommand> & list = commands[material];
+	// records of a material follow each other, the last command ends at the new record
+	if (!list.empty() && list.back().firstIndex == firstIndex && list.back().count == count)
+		list.back().instanceCount++;
+	else {
+		DrawElementsIndirectCommand command = { count, 1, firstIndex, 0, (GLuint)instances[material].size() };
+		list.push_back(command);
+	}
+	instances[material].push_back(instance);
+	objects++;
+}
+
+
+/*
+UPLOAD
+	materials one after another, baseInstance of the commands moved by the records of the materials before
+*/
+void IndirectDraws::upload()
+{
+	allCommands.clear();
+	allInstances.clear();
+	commandOffset.resize(commands.size());
+	for (size_t m = 0; m < commands.size(); m++) {
+		commandOffset[m] = (GLintptr)(allCommands.size() * sizeof(DrawElementsIndirectCommand));
+		GLuint base = (GLuint)allInstances.size();
+		for (size_t c = 0; c < commands[m].size(); c++) {
+			allCommands.push_back(commands[m][c]);
+			allCommands.back().baseInstance += base;
+		}
+		allInstances.insert(allInstances.end(), instances[m].begin(), instances[m].end());
+	}
+	if (allCommands.empty())
+		return;
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, allCommands.size() * sizeof(DrawElementsIndirectCommand), allCommands.data(), GL_STREAM_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+	glBufferData(GL_ARRAY_BUFFER, allInstances.size() * sizeof(glm::vec4), allInstances.data(), GL_STREAM_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void IndirectDraws::draw(int material) const
+{
+	if (commands[material].empty())
+		return;
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+	glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (const void *)commandOffset[material],
+								(GLsizei)commands[material].size(), 0);
+}
+
+size_t IndirectDraws::uploadedBytes() const
+{
+	return allCommands.size() * sizeof(DrawElementsIndirectCommand) + allInstances.size() * sizeof(glm::vec4);
+}
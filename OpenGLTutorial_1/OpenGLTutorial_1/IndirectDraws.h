@@ -0,0 +1,66 @@
+#ifndef INDIRECT_DRAWS_H
+#define INDIRECT_DRAWS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "GL4Functions.h"
+#include "VertexLayout.h"
+
+// record of GL_DRAW_INDIRECT_BUFFER read by glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand {
+	GLuint count;			// indices
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance;	// first per-draw record of the command
+};
+
+// per-draw record of lighting_indirect.vs: position, w = 1 - ground tile (turned flat), 0 - cube
+typedef VertexLayout<VertexAttribute<3, 4, GL_FLOAT, GL_FALSE, 16> > DrawInstance;
+
+/*
+INDIRECT DRAWS
+	objects that survived the CPU culling are written as commands of one material (texture) and drawn
+	with one glMultiDrawElementsIndirect per material instead of a glDrawElements per object,
+	the per-draw data is an instanced attribute (divisor 1) read from baseInstance, so a command
+	finds its records without gl_DrawID (GL 4.6), consecutive objects drawing the same index range
+	become one command with more instances
+	all commands and records of a frame are uploaded at once (the old storage is orphaned)
+*/
+class IndirectDraws
+{
+public:
+	IndirectDraws();
+
+	// buffers (needs the GL context and loadMultiDrawIndirect)
+	void create();
+	void release();
+	// per-draw attribute of the mesh's VAO, its own attributes stay
+	void attach(GLuint VAO) const;
+
+	// start of a frame with this many materials
+	void clear(int materialCount);
+	void add(int material, GLuint firstIndex, GLuint count, const glm::vec4 & instance);
+
+	void upload();
+	// commands of the material on the bound VAO (GL_UNSIGNED_INT indices)
+	void draw(int material) const;
+
+	GLsizei commandCount(int material) const { return (GLsizei)commands[material].size(); }
+	size_t objectCount() const { return objects; }
+	size_t uploadedBytes() const;
+
+private:
+	std::vector<std::vector<DrawElementsIndirectCommand> > commands;
+	std::vector<std::vector<glm::vec4> > instances;
+	std::vector<GLintptr> commandOffset;	// bytes in the command buffer of the first command of the material
+	std::vector<DrawElementsIndirectCommand> allCommands;
+	std::vector<glm::vec4> allInstances;
+	size_t objects;
+	GLuint commandBuffer, instanceBuffer;
+};
+
+#endif
@@ -0,0 +1,340 @@
+#define _CRT_SECURE_NO_DEPRECATE
+
+#include "OcclusionCulling.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <utility>
+
+// glm/glm.hpp includes the intrinsics matching GLM_ARCH (see glm/simd/platform.h)
+
+
+// corners of a box: bit 0 - x, bit 1 - y, bit 2 - z (0 - center - extent, 1 - center + extent)
+static glm::vec3 boxCorner(const glm::vec3 & center, const glm::vec3 & extent, int corner)
+{
+	return center + extent * glm::vec3(corner & 1 ? 1.0f : -1.0f, corner & 2 ? 1.0f : -1.0f, corner & 4 ? 1.0f : -1.0f);
+}
+
+OcclusionCulling::OcclusionCulling()
+	: depth((size_t)BUFFER_WIDTH * BUFFER_HEIGHT, 1.0f), threadCount(0), occluderCount(0), testedCount(0), culledCount(0)
+{
+}
+
+void OcclusionCulling::setThreadCount(unsigned int count)
+{
+	threadCount = count;
+}
+
+
+/*
+CULL
+	occluders are scored by the rough size of their box on the screen: front area / squared distance
+*/
+void OcclusionCulling::cull(const glm::mat4 & viewProjection, const glm::vec3 & eye, const BuildingTable & buildings,
+							std::vector<unsigned int> * visibleBuildings)
+{
+	std::fill(depth.begin(), depth.end(), 1.0f);
+	triangles.clear();
+	occluderCount = testedCount = culledCount = 0;
+
+	std::vector<unsigned int> & candidates = *visibleBuildings;
+	if (candidates.empty())
+		return;
+
+	std::vector<std::pair<float, unsigned int> > scores(candidates.size());
+	for (size_t i = 0; i < candidates.size(); i++) {
+		glm::vec3 center = buildings.center(candidates[i]);
+		glm::vec3 extent = buildings.extent(candidates[i]);
+		glm::vec3 offset = center - eye;
+		float distance2 = std::max(glm::dot(offset, offset), 1.0f);
+		scores[i] = std::make_pair((extent.x + extent.z) * extent.y / distance2, (unsigned int)i);
+	}
+	size_t occluders = std::min((size_t)MAX_OCCLUDERS, scores.size());
+	std::partial_sort(scores.begin(), scores.begin() + occluders, scores.end(),
+					  std::greater<std::pair<float, unsigned int> >());
+
+	// occluders are drawn anyway, they are not tested against themselves
+	std::vector<unsigned char> hidden(candidates.size(), 0);
+	std::vector<unsigned char> isOccluder(candidates.size(), 0);
+	for (size_t i = 0; i < occluders; i++) {
+		unsigned int building = candidates[scores[i].second];
+		isOccluder[scores[i].second] = 1;
+		addOccluder(viewProjection, eye, buildings.center(building), buildings.extent(building));
+	}
+	occluderCount = (unsigned int)occluders;
+
+	unsigned int threads = workerThreadCount(threadCount, MAX_THREADS);
+	if (workers.threadCount() != threads)
+		workers.start(threads);
+
+	auto rasterize = [&](unsigned int t) {
+		rasterizeRows(BUFFER_HEIGHT * t / threads, BUFFER_HEIGHT * (t + 1) / threads);
+	};
+	workers.run(rasterize);
+
+	auto test = [&](unsigned int t) {
+		size_t first = candidates.size() * t / threads;
+		size_t end = candidates.size() * (t + 1) / threads;
+		for (size_t i = first; i < end; i++) {
+			if (!isOccluder[i])
+				hidden[i] = isBoxOccluded(viewProjection, buildings.center(candidates[i]), buildings.extent(candidates[i]));
+		}
+	};
+	workers.run(test);
+
+	size_t kept = 0;
+	for (size_t i = 0; i < candidates.size(); i++) {
+		if (!hidden[i])
+			candidates[kept++] = candidates[i];
+	}
+	testedCount = (unsigned int)(candidates.size() - occluders);
+	culledCount = (unsigned int)(candidates.size() - kept);
+	candidates.resize(kept);
+}
+
+
+/*
+ADD OCCLUDER
+	only faces turned to the eye - the back ones are always behind them
+*/
+void OcclusionCulling::addOccluder(const glm::mat4 & viewProjection, const glm::vec3 & eye,
+								   const glm::vec3 & center, const glm::vec3 & extent)
+{
+	// -x, +x, -y, +y, -z, +z
+	static const int faces[6][4] = {
+		{ 0, 2, 6, 4 }, { 1, 5, 7, 3 },
+		{ 0, 4, 5, 1 }, { 2, 3, 7, 6 },
+		{ 0, 1, 3, 2 }, { 4, 6, 7, 5 }
+	};
+
+	glm::vec4 corners[8];
+	for (int i = 0; i < 8; i++)
+		corners[i] = viewProjection * glm::vec4(boxCorner(center, extent, i), 1.0f);
+
+	for (int face = 0; face < 6; face++) {
+		int axis = face / 2;
+		bool facesEye = face % 2 == 0 ? eye[axis] < center[axis] - extent[axis] : eye[axis] > center[axis] + extent[axis];
+		if (!facesEye)
+			continue;
+		const int * quad = faces[face];
+		addTriangle(corners[quad[0]], corners[quad[1]], corners[quad[2]]);
+		addTriangle(corners[quad[0]], corners[quad[2]], corners[quad[3]]);
+	}
+}
+
+
+/*
+ADD TRIANGLE
+	clip against the near plane (z + w >= 0) in clip space, then move to buffer space
+	one clipped corner gives a quad, so up to 2 triangles are stored
+*/
+void OcclusionCulling::addTriangle(const glm::vec4 & a, const glm::vec4 & b, const glm::vec4 & c)
+{
+	const glm::vec4 input[3] = { a, b, c };
+	glm::vec4 clipped[4];
+	int count = 0;
+	for (int i = 0; i < 3; i++) {
+		const glm::vec4 & current = input[i];
+		const glm::vec4 & next = input[(i + 1) % 3];
+		float currentDistance = current.z + current.w;
+		float nextDistance = next.z + next.w;
+		if (currentDistance >= 0.0f)
+			clipped[count++] = current;
+		if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f))
+			clipped[count++] = glm::mix(current, next, currentDistance / (currentDistance - nextDistance));
+	}
+	if (count < 3)
+		return;
+
+	glm::vec3 screen[4];
+	for (int i = 0; i < count; i++) {
+		glm::vec3 ndc = glm::vec3(clipped[i]) / clipped[i].w;
+		screen[i] = glm::vec3((ndc.x * 0.5f + 0.5f) * BUFFER_WIDTH, (ndc.y * 0.5f + 0.5f) * BUFFER_HEIGHT, ndc.z * 0.5f + 0.5f);
+	}
+	for (int i = 1; i + 1 < count; i++) {
+		ScreenTriangle triangle = { { screen[0], screen[i], screen[i + 1] } };
+		triangles.push_back(triangle);
+	}
+}
+
+
+/*
+RASTERIZE ROWS
+	edge functions E(x, y) = A * x + B * y + C are positive inside of the triangle,
+	depth is a plane over the screen, pixel is covered when its center is inside
+*/
+void OcclusionCulling::rasterizeRows(int firstRow, int endRow)
+{
+	for (size_t t = 0; t < triangles.size(); t++) {
+		glm::vec3 v0 = triangles[t].v[0], v1 = triangles[t].v[1], v2 = triangles[t].v[2];
+		float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+		if (fabs(area) < 1.0e-6f)
+			continue;
+		if (area < 0.0f) {
+			std::swap(v1, v2);
+			area = -area;
+		}
+
+		int minX = std::max(0, (int)floor(std::min(v0.x, std::min(v1.x, v2.x))));
+		int maxX = std::min(BUFFER_WIDTH - 1, (int)floor(std::max(v0.x, std::max(v1.x, v2.x))));
+		int minY = std::max(firstRow, (int)floor(std::min(v0.y, std::min(v1.y, v2.y))));
+		int maxY = std::min(endRow - 1, (int)floor(std::max(v0.y, std::max(v1.y, v2.y))));
+		if (minX > maxX || minY > maxY)
+			continue;
+
+		// edge i is opposite to vertex i, its function is the (unnormalized) barycentric weight of vertex i
+		const glm::vec3 from[3] = { v1, v2, v0 };
+		const glm::vec3 to[3] = { v2, v0, v1 };
+		float A[3], B[3], C[3];
+		for (int e = 0; e < 3; e++) {
+			A[e] = -(to[e].y - from[e].y);
+			B[e] = to[e].x - from[e].x;
+			C[e] = -(A[e] * from[e].x + B[e] * from[e].y);
+		}
+		float zx = (A[0] * v0.z + A[1] * v1.z + A[2] * v2.z) / area;
+		float zy = (B[0] * v0.z + B[1] * v1.z + B[2] * v2.z) / area;
+		float zc = (C[0] * v0.z + C[1] * v1.z + C[2] * v2.z) / area;
+
+		// rows start on a multiple of 4, BUFFER_WIDTH is a multiple of 4 so the last group stays inside the row
+		int startX = minX & ~3;
+		for (int y = minY; y <= maxY; y++) {
+			float py = y + 0.5f;
+			float * row = &depth[(size_t)y * BUFFER_WIDTH];
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+			const __m128 zero = _mm_setzero_ps();
+			__m128 px = _mm_add_ps(_mm_set1_ps((float)startX), _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f));
+			__m128 e[3], step[3];
+			for (int i = 0; i < 3; i++) {
+				e[i] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(A[i]), px), _mm_set1_ps(B[i] * py + C[i]));
+				step[i] = _mm_set1_ps(4.0f * A[i]);
+			}
+			__m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(zx), px), _mm_set1_ps(zy * py + zc));
+			const __m128 zStep = _mm_set1_ps(4.0f * zx);
+			for (int x = startX; x <= maxX; x += 4) {
+				__m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e[0], zero), _mm_cmpge_ps(e[1], zero)), _mm_cmpge_ps(e[2], zero));
+				if (_mm_movemask_ps(inside) != 0) {
+					__m128 current = _mm_loadu_ps(row + x);
+					__m128 nearer = _mm_min_ps(current, z);
+					_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, current)));
+				}
+				for (int i = 0; i < 3; i++)
+					e[i] = _mm_add_ps(e[i], step[i]);
+				z = _mm_add_ps(z, zStep);
+			}
+#else
+			for (int x = minX; x <= maxX; x++) {
+				float px = x + 0.5f;
+				if (A[0] * px + B[0] * py + C[0] >= 0.0f && A[1] * px + B[1] * py + C[1] >= 0.0f &&
+					A[2] * px + B[2] * py + C[2] >= 0.0f)
+					row[x] = std::min(row[x], zx * px + zy * py + zc);
+			}
+#endif
+		}
+	}
+}
+
+
+/*
+IS BOX OCCLUDED
+	conservative: the nearest corner of the box against every pixel of its screen rectangle
+	a box crossing the near plane is always visible, a box outside of the screen is never
+*/
+bool OcclusionCulling::isBoxOccluded(const glm::mat4 & viewProjection, const glm::vec3 & center, const glm::vec3 & extent) const
+{
+	glm::vec2 screenMin(INFINITY), screenMax(-INFINITY);
+	float nearest = INFINITY;
+	for (int i = 0; i < 8; i++) {
+		glm::vec4 clip = viewProjection * glm::vec4(boxCorner(center, extent, i), 1.0f);
+		if (clip.z + clip.w < 0.0f)
+			return false;
+		glm::vec3 ndc = glm::vec3(clip) / clip.w;
+		glm::vec2 screen((ndc.x * 0.5f + 0.5f) * BUFFER_WIDTH, (ndc.y * 0.5f + 0.5f) * BUFFER_HEIGHT);
+		screenMin = glm::min(screenMin, screen);
+		screenMax = glm::max(screenMax, screen);
+		nearest = std::min(nearest, ndc.z * 0.5f + 0.5f);
+	}
+
+	int minX = std::max(0, (int)floor(screenMin.x));
+	int maxX = std::min(BUFFER_WIDTH - 1, (int)floor(screenMax.x));
+	int minY = std::max(0, (int)floor(screenMin.y));
+	int maxY = std::min(BUFFER_HEIGHT - 1, (int)floor(screenMax.y));
+	if (minX > maxX || minY > maxY)
+		return true;
+
+	for (int y = minY; y <= maxY; y++) {
+		const float * row = &depth[(size_t)y * BUFFER_WIDTH];
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+		const __m128 boxDepth = _mm_set1_ps(nearest);
+		for (int x = minX & ~3; x <= maxX; x += 4) {
+			// lanes of the group that lie inside <minX, maxX>
+			int lanes = 0xF;
+			if (x < minX)
+				lanes &= 0xF << (minX - x);
+			if (x + 3 > maxX)
+				lanes &= 0xF >> (x + 3 - maxX);
+			if (_mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(row + x), boxDepth)) & lanes)
+				return false;
+		}
+#else
+		for (int x = minX; x <= maxX; x++) {
+			if (row[x] >= nearest)
+				return false;
+		}
+#endif
+	}
+	return true;
+}
+
+
+std::string OcclusionCulling::dumpPath()
+{
+	const char * names[] = { "TMPDIR", "TEMP", "TMP" };
+	for (int i = 0; i < 3; i++) {
+		const char * directory = getenv(names[i]);
+		if (directory != NULL && directory[0] != '\0')
+			return std::string(directory) + "/occlusion.pgm";
+	}
+#if defined(_WIN32)
+	return "occlusion.pgm";
+#else
+	return "/tmp/occlusion.pgm";
+#endif
+}
+
+
+/*
+DUMP DEPTH
+	empty pixels are black, covered ones go from white (nearest) to dark grey (farthest)
+*/
+bool OcclusionCulling::dumpDepth(const char * fileName) const
+{
+	float nearest = 1.0f;
+	for (size_t i = 0; i < depth.size(); i++)
+		nearest = std::min(nearest, depth[i]);
+	float range = std::max(1.0f - nearest, 1.0e-6f);
+
+	FILE * file = fopen(fileName, "wb");
+	if (file == NULL) {
+		std::cout << "Occlusion buffer can't be written to: " << fileName << std::endl;
+		return false;
+	}
+	fprintf(file, "P5\n%d %d\n255\n", BUFFER_WIDTH, BUFFER_HEIGHT);
+	std::vector<unsigned char> row(BUFFER_WIDTH);
+	// image rows go from the top, buffer rows from the bottom
+	for (int y = BUFFER_HEIGHT - 1; y >= 0; y--) {
+		for (int x = 0; x < BUFFER_WIDTH; x++) {
+			float d = depthAt(x, y);
+			row[x] = d >= 1.0f ? 0 : (unsigned char)(40.0f + 215.0f * (1.0f - (d - nearest) / range));
+		}
+		fwrite(row.data(), 1, row.size(), file);
+	}
+	bool ok = ferror(file) == 0;
+	fclose(file);
+	if (ok)
+		std::cout << "Occlusion buffer written to " << fileName << std::endl;
+	return ok;
+}
@@ -0,0 +1,72 @@
+#ifndef OCCLUSION_CULLING_H
+#define OCCLUSION_CULLING_H
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+#include "BuildingTable.h"
+#include "WorkerThreads.h"
+
+/*
+OCCLUSION CULLING
+	software depth buffer of low resolution, filled on the CPU (no GL calls):
+	1. the nearest large buildings among the frustum-visible ones are chosen as occluders
+	2. front faces of their boxes are rasterized into the buffer, 4 pixels at a time, one band of rows per thread
+	3. every other building is visible only if some pixel under its screen rectangle is farther than its nearest corner
+	buildings are full columns of cubes, so their box is an exact occluder
+*/
+class OcclusionCulling
+{
+public:
+	// 4:3 like the window, width has to be a multiple of 4
+	static const int BUFFER_WIDTH = 256;
+	static const int BUFFER_HEIGHT = 192;
+	static const unsigned int MAX_OCCLUDERS = 64;
+	static const unsigned int MAX_THREADS = 8;
+
+	OcclusionCulling();
+
+	// 0 - one thread per hardware thread (at most MAX_THREADS)
+	void setThreadCount(unsigned int count);
+
+	// remove hidden buildings from visibleBuildings, order of the rest is kept
+	void cull(const glm::mat4 & viewProjection, const glm::vec3 & eye, const BuildingTable & buildings,
+			  std::vector<unsigned int> * visibleBuildings);
+
+	// statistics of the last cull
+	unsigned int occluders() const { return occluderCount; }
+	unsigned int tested() const { return testedCount; }
+	unsigned int culled() const { return culledCount; }
+
+	// depth in [0, 1] (0 - near plane, 1 - empty), y = 0 is the bottom row
+	float depthAt(int x, int y) const { return depth[(size_t)y * BUFFER_WIDTH + x]; }
+
+	// write the buffer as a binary PGM image, nearer is brighter
+	bool dumpDepth(const char * fileName) const;
+	// occlusion.pgm in the temporary directory of the system, out of the source tree the app runs in
+	static std::string dumpPath();
+
+private:
+	// triangle in buffer space: x, y in pixels, z - depth
+	struct ScreenTriangle {
+		glm::vec3 v[3];
+	};
+
+	void addOccluder(const glm::mat4 & viewProjection, const glm::vec3 & eye, const glm::vec3 & center, const glm::vec3 & extent);
+	void addTriangle(const glm::vec4 & a, const glm::vec4 & b, const glm::vec4 & c);
+	void rasterizeRows(int firstRow, int endRow);
+	bool isBoxOccluded(const glm::mat4 & viewProjection, const glm::vec3 & center, const glm::vec3 & extent) const;
+
+	std::vector<float> depth;
+	std::vector<ScreenTriangle> triangles;
+	unsigned int threadCount;
+	WorkerPool workers;		// started by the first cull after setThreadCount
+
+	unsigned int occluderCount;
+	unsigned int testedCount;
+	unsigned int culledCount;
+};
+
+#endif
@@ -0,0 +1,113 @@
+#include "OcclusionQueries.h"
+
+#include <chrono>
+
+
+// the near plane is 0.1 in front of the eye, this keeps boxes clear of it in every direction
+static const float NEAR_PLANE_MARGIN = 0.5f;
+
+
+OcclusionQueries::OcclusionQueries()
+	: frame(0), conditionActive(false), issuedCount(0), conditionalCount(0), culledCount(0), lateCount(0), stallMs(0.0)
+{
+}
+
+void OcclusionQueries::resize(size_t blockCount)
+{
+	release();
+	BlockQueries empty = { { 0, 0 }, { 0, 0 } };
+	blocks.assign(blockCount, empty);
+}
+
+void OcclusionQueries::release()
+{
+	for (size_t i = 0; i < blocks.size(); i++) {
+		if (blocks[i].ids[0] != 0)
+			glDeleteQueries(2, blocks[i].ids);
+		blocks[i].ids[0] = blocks[i].ids[1] = 0;
+		blocks[i].issuedFrame[0] = blocks[i].issuedFrame[1] = 0;
+	}
+	pending.clear();
+}
+
+
+/*
+BEGIN FRAME
+	GL_QUERY_RESULT is asked for only after GL_QUERY_RESULT_AVAILABLE said yes,
+	results of slots that were issued again in the meantime are dropped
+*/
+void OcclusionQueries::beginFrame()
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	frame++;
+	issuedCount = conditionalCount = culledCount = lateCount = 0;
+
+	size_t kept = 0;
+	for (size_t i = 0; i < pending.size(); i++) {
+		const Pending & query = pending[i];
+		const BlockQueries & block = blocks[query.block];
+		if (block.issuedFrame[query.slot] != query.frame)
+			continue;
+
+		GLuint available = GL_FALSE;
+		glGetQueryObjectuiv(block.ids[query.slot], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available) {
+			GLuint anySamples = GL_FALSE;
+			glGetQueryObjectuiv(block.ids[query.slot], GL_QUERY_RESULT, &anySamples);
+			if (!anySamples)
+				culledCount++;
+			continue;
+		}
+		if (frame - query.frame == 2)
+			lateCount++;
+		pending[kept++] = query;
+	}
+	pending.resize(kept);
+
+	stallMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+
+void OcclusionQueries::beginBlock(unsigned int block)
+{
+	unsigned int previous = (frame - 1) & 1;
+	conditionActive = blocks[block].issuedFrame[previous] == frame - 1 && frame > 1;
+	if (conditionActive) {
+		glBeginConditionalRender(blocks[block].ids[previous], GL_QUERY_NO_WAIT);
+		conditionalCount++;
+	}
+}
+
+void OcclusionQueries::endBlock()
+{
+	if (conditionActive)
+		glEndConditionalRender();
+	conditionActive = false;
+}
+
+
+void OcclusionQueries::beginQuery(unsigned int block)
+{
+	BlockQueries & queries = blocks[block];
+	if (queries.ids[0] == 0)
+		glGenQueries(2, queries.ids);
+
+	unsigned int slot = frame & 1;
+	glBeginQuery(GL_ANY_SAMPLES_PASSED, queries.ids[slot]);
+	queries.issuedFrame[slot] = frame;
+	Pending query = { block, slot, frame };
+	pending.push_back(query);
+	issuedCount++;
+}
+
+void OcclusionQueries::endQuery()
+{
+	glEndQuery(GL_ANY_SAMPLES_PASSED);
+}
+
+
+bool OcclusionQueries::canQueryBox(const glm::vec3 & eye, const glm::vec3 & boxMin, const glm::vec3 & boxMax)
+{
+	glm::vec3 margin(NEAR_PLANE_MARGIN);
+	return glm::any(glm::lessThan(eye, boxMin - margin)) || glm::any(glm::greaterThan(eye, boxMax + margin));
+}
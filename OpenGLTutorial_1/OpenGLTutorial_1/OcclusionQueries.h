@@ -0,0 +1,73 @@
+#ifndef OCCLUSION_QUERIES_H
+#define OCCLUSION_QUERIES_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/*
+OCCLUSION QUERIES
+	GPU culling of city blocks (quadtree leaves) with GL_ANY_SAMPLES_PASSED queries on their bounding boxes
+	frame N draws a block inside glBeginConditionalRender on the query issued for it in frame N - 1
+	(GL_QUERY_NO_WAIT - if the result isn't ready the block is simply drawn), and after the scene
+	issues new queries for frame N + 1; every block has two query objects used in turns
+	results are read on the CPU only for statistics and only when already available, so nothing waits
+*/
+class OcclusionQueries
+{
+public:
+	OcclusionQueries();
+
+	// one slot per block index, query objects are created when a block is queried for the first time
+	void resize(size_t blockCount);
+	// delete query objects (needs the GL context)
+	void release();
+
+	// start of a frame: read results that are already available
+	void beginFrame();
+
+	// draws of the block between these calls are skipped by the GPU if its last box was hidden
+	void beginBlock(unsigned int block);
+	void endBlock();
+
+	// the box of the block is drawn between these calls (color and depth writes off)
+	void beginQuery(unsigned int block);
+	void endQuery();
+
+	// a box query is meaningful only when the whole box is in front of the near plane
+	static bool canQueryBox(const glm::vec3 & eye, const glm::vec3 & boxMin, const glm::vec3 & boxMax);
+
+	// statistics of the frame
+	unsigned int issued() const { return issuedCount; }
+	unsigned int conditional() const { return conditionalCount; }
+	unsigned int culledBlocks() const { return culledCount; }		// results read this frame that found no sample
+	unsigned int lateResults() const { return lateCount; }			// results still not available after a frame
+	double stallMilliseconds() const { return stallMs; }			// CPU time spent reading results
+
+private:
+	struct BlockQueries {
+		GLuint ids[2];
+		unsigned int issuedFrame[2];	// frame in which the slot was last issued, 0 - never (frames start at 1)
+	};
+
+	// query slot waiting for its result
+	struct Pending {
+		unsigned int block;
+		unsigned int slot;
+		unsigned int frame;
+	};
+
+	std::vector<BlockQueries> blocks;
+	std::vector<Pending> pending;
+	unsigned int frame;
+	bool conditionActive;
+
+	unsigned int issuedCount;
+	unsigned int conditionalCount;
+	unsigned int culledCount;
+	unsigned int lateCount;
+	double stallMs;
+};
+
+#endif
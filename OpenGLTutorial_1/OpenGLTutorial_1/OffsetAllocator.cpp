@@ -0,0 +1,221 @@
+#include "OffsetAllocator.h"
+
+#include <algorithm>
+
+// index of the lowest / highest set bit (the value is not 0)
+static uint32_t lowestBit(uint32_t value)
+{
+	uint32_t bit = 0;
+	while ((value & 1u) == 0) {
+		value >>= 1;
+		bit++;
+	}
+	return bit;
+}
+
+static uint32_t highestBit(uint32_t value)
+{
+	uint32_t bit = 0;
+	while (value >>= 1)
+		bit++;
+	return bit;
+}
+
+
+OffsetAllocator::OffsetAllocator(uint32_t size)
+{
+	reset(size);
+}
+
+void OffsetAllocator::reset(uint32_t size)
+{
+	nodes.clear();
+	unusedNodes.clear();
+	for (int bin = 0; bin < BINS; bin++)
+		binHeads[bin] = NONE;
+	for (int word = 0; word < BINS / 32; word++)
+		binMasks[word] = 0;
+	wordMask = 0;
+	totalSize = size;
+	used = 0;
+	freeRanges = 0;
+	if (size > 0)
+		insertFree(newNode(0, size));
+}
+
+
+/*
+BINS
+	sizes below 2^(SECOND_LEVEL_BITS + 1) have a bin each, then every power of two has 8 bins:
+	bin = (power - 2) * 8 + the 3 bits under the highest bit, sizes in a bin grow by at most 1/8
+*/
+uint32_t OffsetAllocator::binOf(uint32_t size)
+{
+	const uint32_t linear = 1u << (SECOND_LEVEL_BITS + 1);
+	if (size < linear)
+		return size;
+	uint32_t power = highestBit(size);
+	uint32_t step = (size >> (power - SECOND_LEVEL_BITS)) & ((1u << SECOND_LEVEL_BITS) - 1);
+	return ((power - SECOND_LEVEL_BITS + 1) << SECOND_LEVEL_BITS) + step;
+}
+
+uint32_t OffsetAllocator::binSize(uint32_t bin)
+{
+	const uint32_t linear = 1u << (SECOND_LEVEL_BITS + 1);
+	if (bin < linear)
+		return bin;
+	uint32_t power = (bin >> SECOND_LEVEL_BITS) + SECOND_LEVEL_BITS - 1;
+	uint32_t step = bin & ((1u << SECOND_LEVEL_BITS) - 1);
+	return ((1u << SECOND_LEVEL_BITS) + step) << (power - SECOND_LEVEL_BITS);
+}
+
+uint32_t OffsetAllocator::findBin(uint32_t bin) const
+{
+	if (bin >= (uint32_t)BINS)
+		return NONE;
+	uint32_t word = bin / 32;
+	uint32_t bits = binMasks[word] & (0xffffffffu << (bin % 32));
+	if (bits != 0)
+		return word * 32 + lowestBit(bits);
+	uint32_t words = word + 1 < 32 ? wordMask & (0xffffffffu << (word + 1)) : 0;
+	if (words == 0)
+		return NONE;
+	word = lowestBit(words);
+	return word * 32 + lowestBit(binMasks[word]);
+}
+
+
+uint32_t OffsetAllocator::newNode(uint32_t offset, uint32_t size)
+{
+	Node node = { offset, size, NONE, NONE, NONE, NONE, false };
+	if (!unusedNodes.empty()) {
+		uint32_t index = unusedNodes.back();
+		unusedNodes.pop_back();
+		nodes[index] = node;
+		return index;
+	}
+	nodes.push_back(node);
+	return (uint32_t)nodes.size() - 1;
+}
+
+void OffsetAllocator::insertFree(uint32_t index)
+{
+	Node & node = nodes[index];
+	uint32_t bin = binOf(node.size);
+	node.used = false;
+	node.binPrevious = NONE;
+	node.binNext = binHeads[bin];
+	if (node.binNext != NONE)
+		nodes[node.binNext].binPrevious = index;
+	binHeads[bin] = index;
+	binMasks[bin / 32] |= 1u << (bin % 32);
+	wordMask |= 1u << (bin / 32);
+	freeRanges++;
+}
+
+void OffsetAllocator::removeFree(uint32_t index)
+{
+	Node & node = nodes[index];
+	uint32_t bin = binOf(node.size);
+	if (node.binPrevious != NONE)
+		nodes[node.binPrevious].binNext = node.binNext;
+	else
+		binHeads[bin] = node.binNext;
+	if (node.binNext != NONE)
+		nodes[node.binNext].binPrevious = node.binPrevious;
+	if (binHeads[bin] == NONE) {
+		binMasks[bin / 32] &= ~(1u << (bin % 32));
+		if (binMasks[bin / 32] == 0)
+			wordMask &= ~(1u << (bin / 32));
+	}
+	freeRanges--;
+}
+
+
+/*
+ALLOCATE
+	a bin whose smallest range is at least the size (the size rounded up to a bin), so the first range
+	of the bin fits, the rest of the range stays free right after the allocation
+*/
+OffsetAllocator::Allocation OffsetAllocator::allocate(uint32_t size)
+{
+	Allocation failed = { NO_SPACE, NONE };
+	if (size == 0)
+		size = 1;
+	uint32_t bin = binOf(size);
+	if (binSize(bin) < size)
+		bin++;
+	bin = findBin(bin);
+	if (bin == NONE)
+		return failed;
+
+	uint32_t index = binHeads[bin];
+	removeFree(index);
+	uint32_t rest = nodes[index].size - size;
+	if (rest > 0) {
+		uint32_t restIndex = newNode(nodes[index].offset + size, rest);
+		nodes[restIndex].previous = index;
+		nodes[restIndex].next = nodes[index].next;
+		if (nodes[index].next != NONE)
+			nodes[nodes[index].next].previous = restIndex;
+		nodes[index].next = restIndex;
+		nodes[index].size = size;
+		insertFree(restIndex);
+	}
+	nodes[index].used = true;
+	used += size;
+	Allocation allocation = { nodes[index].offset, index };
+	return allocation;
+}
+
+void OffsetAllocator::free(const Allocation & allocation)
+{
+	if (allocation.offset == NO_SPACE)
+		return;
+	uint32_t index = allocation.node;
+	used -= nodes[index].size;
+
+	// the free range before takes this one, the free range after is taken
+	uint32_t previous = nodes[index].previous;
+	if (previous != NONE && !nodes[previous].used) {
+		removeFree(previous);
+		nodes[previous].size += nodes[index].size;
+		nodes[previous].next = nodes[index].next;
+		if (nodes[index].next != NONE)
+			nodes[nodes[index].next].previous = previous;
+		unusedNodes.push_back(index);
+		index = previous;
+	}
+	uint32_t next = nodes[index].next;
+	if (next != NONE && !nodes[next].used) {
+		removeFree(next);
+		nodes[index].size += nodes[next].size;
+		nodes[index].next = nodes[next].next;
+		if (nodes[next].next != NONE)
+			nodes[nodes[next].next].previous = index;
+		unusedNodes.push_back(next);
+	}
+	insertFree(index);
+}
+
+
+uint32_t OffsetAllocator::largestFreeRange() const
+{
+	for (int bin = BINS - 1; bin >= 0; bin--) {
+		if (binHeads[bin] == NONE)
+			continue;
+		uint32_t largest = 0;
+		for (uint32_t index = binHeads[bin]; index != NONE; index = nodes[index].binNext)
+			largest = std::max(largest, nodes[index].size);
+		return largest;
+	}
+	return 0;
+}
+
+float OffsetAllocator::fragmentation() const
+{
+	uint32_t freeTotal = freeSize();
+	if (freeTotal == 0)
+		return 0.0f;
+	return 1.0f - (float)largestFreeRange() / (float)freeTotal;
+}
@@ -0,0 +1,72 @@
+#ifndef OFFSET_ALLOCATOR_H
+#define OFFSET_ALLOCATOR_H
+
+#include <stdint.h>
+#include <vector>
+
+/*
+OFFSET ALLOCATOR
+	ranges of a fixed size space (vertices or indices of a GPU buffer), it owns no memory, only offsets
+	TLSF (two-level segregated fit): free ranges are kept in bins by size, the first level is the power
+	of two of the size, the second splits it into 8 linear steps; two bit masks find a bin with a range
+	at least as big as asked in constant time, the range is split and the rest goes back to its bin
+	a freed range is merged with free neighbours (every range knows the ranges before and after it),
+	so the space doesn't crumble into small pieces
+*/
+class OffsetAllocator
+{
+public:
+	static const uint32_t NO_SPACE = 0xffffffff;
+	static const int SECOND_LEVEL_BITS = 3;
+	static const int BINS = 256;
+
+	struct Allocation {
+		uint32_t offset;	// NO_SPACE - failed
+		uint32_t node;		// for free
+	};
+
+	explicit OffsetAllocator(uint32_t size = 0);
+
+	// everything free again, one range of this size
+	void reset(uint32_t size);
+
+	Allocation allocate(uint32_t size);
+	void free(const Allocation & allocation);
+
+	uint32_t capacity() const { return totalSize; }
+	uint32_t usedSize() const { return used; }
+	uint32_t freeSize() const { return totalSize - used; }
+	uint32_t largestFreeRange() const;
+	uint32_t freeRangeCount() const { return freeRanges; }
+	// 0 - all free space is one range, close to 1 - free space in many small pieces
+	float fragmentation() const;
+
+	// bin of the ranges of this size (rounded down) and the smallest size the bin holds
+	static uint32_t binOf(uint32_t size);
+	static uint32_t binSize(uint32_t bin);
+
+private:
+	static const uint32_t NONE = 0xffffffff;
+
+	struct Node {
+		uint32_t offset, size;
+		uint32_t previous, next;		// neighbours in the space, NONE at its ends
+		uint32_t binPrevious, binNext;	// free ranges of the same bin
+		bool used;
+	};
+
+	uint32_t newNode(uint32_t offset, uint32_t size);
+	void insertFree(uint32_t node);
+	void removeFree(uint32_t node);
+	// first non-empty bin from this one up, NONE if there is none
+	uint32_t findBin(uint32_t bin) const;
+
+	std::vector<Node> nodes;
+	std::vector<uint32_t> unusedNodes;
+	uint32_t binHeads[BINS];
+	uint32_t binMasks[BINS / 32];	// bit - bin not empty
+	uint32_t wordMask;				// bit - word of binMasks not zero
+	uint32_t totalSize, used, freeRanges;
+};
+
+#endif
@@ -0,0 +1,97 @@
+#include "PipelineStatistics.h"
+
+#include "GL4Functions.h"
+
+// query targets of Pipeline_Counter
+static const GLenum COUNTER_TARGETS[COUNTER_COUNT] = { GL_VERTEX_SHADER_INVOCATIONS, GL_FRAGMENT_SHADER_INVOCATIONS,
+														GL_CLIPPING_INPUT_PRIMITIVES, GL_CLIPPING_OUTPUT_PRIMITIVES };
+
+
+PipelineStatistics::PipelineStatistics()
+	: counterQueries(false), frame(0)
+{
+	for (int f = 0; f < FRAMES; f++) {
+		timeQueries[f] = 0;
+		for (int c = 0; c < COUNTER_COUNT; c++)
+			counterIds[c][f] = 0;
+		pending[f] = false;
+	}
+	resetStats();
+}
+
+
+void PipelineStatistics::create()
+{
+	counterQueries = hasPipelineStatistics();
+	glGenQueries(FRAMES, timeQueries);
+	if (counterQueries)
+		for (int c = 0; c < COUNTER_COUNT; c++)
+			glGenQueries(FRAMES, counterIds[c]);
+	frame = 0;
+}
+
+void PipelineStatistics::release()
+{
+	if (timeQueries[0] != 0)
+		glDeleteQueries(FRAMES, timeQueries);
+	for (int c = 0; c < COUNTER_COUNT; c++)
+		if (counterIds[c][0] != 0)
+			glDeleteQueries(FRAMES, counterIds[c]);
+	for (int f = 0; f < FRAMES; f++) {
+		timeQueries[f] = 0;
+		for (int c = 0; c < COUNTER_COUNT; c++)
+			counterIds[c][f] = 0;
+		pending[f] = false;
+	}
+}
+
+
+void PipelineStatistics::begin()
+{
+	frame = (frame + 1) % FRAMES;
+	if (pending[frame])
+		lostCount++;
+	glBeginQuery(GL_TIME_ELAPSED, timeQueries[frame]);
+	if (counterQueries)
+		for (int c = 0; c < COUNTER_COUNT; c++)
+			glBeginQuery(COUNTER_TARGETS[c], counterIds[c][frame]);
+}
+
+void PipelineStatistics::end()
+{
+	if (counterQueries)
+		for (int c = 0; c < COUNTER_COUNT; c++)
+			glEndQuery(COUNTER_TARGETS[c]);
+	glEndQuery(GL_TIME_ELAPSED);
+	pending[frame] = true;
+
+	for (int f = 0; f < FRAMES; f++) {
+		if (!pending[f] || f == frame)
+			continue;
+		GLuint available = GL_FALSE;
+		glGetQueryObjectuiv(timeQueries[f], GL_QUERY_RESULT_AVAILABLE, &available);
+		for (int c = 0; c < COUNTER_COUNT && available && counterQueries; c++)
+			glGetQueryObjectuiv(counterIds[c][f], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+			continue;
+		GLuint64 nanoseconds = 0;
+		glGetQueryObjectui64v(timeQueries[f], GL_QUERY_RESULT, &nanoseconds);
+		gpuMs += nanoseconds / 1000000.0;
+		for (int c = 0; c < COUNTER_COUNT && counterQueries; c++) {
+			GLuint64 value = 0;
+			glGetQueryObjectui64v(counterIds[c][f], GL_QUERY_RESULT, &value);
+			counterSums[c] += (double)value;
+		}
+		resultCount++;
+		pending[f] = false;
+	}
+}
+
+
+void PipelineStatistics::resetStats()
+{
+	resultCount = lostCount = 0;
+	for (int c = 0; c < COUNTER_COUNT; c++)
+		counterSums[c] = 0.0;
+	gpuMs = 0.0;
+}
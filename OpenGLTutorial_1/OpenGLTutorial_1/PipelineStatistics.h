@@ -0,0 +1,59 @@
+#ifndef PIPELINE_STATISTICS_H
+#define PIPELINE_STATISTICS_H
+
+#include <glad/glad.h>
+
+// Counters of pipeline statistics queries
+enum Pipeline_Counter {
+	COUNTER_VERTEX_SHADER,		// vertex shader invocations
+	COUNTER_FRAGMENT_SHADER,	// fragment shader invocations
+	COUNTER_CLIPPING_INPUT,		// primitives that reached clipping
+	COUNTER_CLIPPING_OUTPUT,	// primitives that left clipping (to culling and rasterization)
+	COUNTER_COUNT
+};
+
+/*
+PIPELINE STATISTICS
+	GPU side of a frame: pipeline statistics counters (when the driver has pipeline statistics queries)
+	and GPU time (GL_TIME_ELAPSED) of the draws between begin and end
+	every frame has its own queries out of FRAMES, results are read only when already available,
+	so they arrive a frame or two late and nothing waits for the GPU
+*/
+class PipelineStatistics
+{
+public:
+	static const int FRAMES = 4;
+
+	PipelineStatistics();
+
+	// query objects (needs the GL context)
+	void create();
+	void release();
+
+	// draws of the frame between these calls are measured, end reads the finished results
+	void begin();
+	void end();
+
+	bool hasCounters() const { return counterQueries; }
+
+	// sums of the results read by end since resetStats
+	unsigned int results() const { return resultCount; }
+	double counter(Pipeline_Counter counter) const { return counterSums[counter]; }
+	double gpuMilliseconds() const { return gpuMs; }
+	// frames whose queries were issued again before their results came
+	unsigned int lostResults() const { return lostCount; }
+	void resetStats();
+
+private:
+	GLuint timeQueries[FRAMES];
+	GLuint counterIds[COUNTER_COUNT][FRAMES];
+	bool pending[FRAMES];
+	bool counterQueries;
+	int frame;
+
+	unsigned int resultCount, lostCount;
+	double counterSums[COUNTER_COUNT];
+	double gpuMs;
+};
+
+#endif
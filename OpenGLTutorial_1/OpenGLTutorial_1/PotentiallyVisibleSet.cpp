@@ -0,0 +1,190 @@
+#include "PotentiallyVisibleSet.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <utility>
+
+#include "HorizonCulling.h"
+#include "WorkerThreads.h"
+
+
+// samples split the cell into SAMPLES_PER_SIDE^2 squares, every eye is at most half a diagonal from one
+static const float SAMPLE_SPACING = 1.0f / PotentiallyVisibleSet::SAMPLES_PER_SIDE;
+static const float OCCLUDER_SHRINK = SAMPLE_SPACING * 0.7072f;
+// farthest sample from the center of the cell
+static const float SAMPLE_OFFSET = (0.5f - SAMPLE_SPACING * 0.5f) * 1.4143f;
+// farthest eye covered by the cell from its center (half a diagonal)
+static const float CELL_OFFSET = 0.7072f;
+
+
+/*
+ENCODE
+	ascending building indices to runs of words
+*/
+static void encodeBitset(const std::vector<unsigned int> & buildings, std::vector<uint64_t> * out)
+{
+	size_t i = 0;
+	uint64_t nextWord = 0;		// first word not covered by the output yet
+	while (i < buildings.size()) {
+		uint64_t firstWord = buildings[i] / 64;
+		size_t headerAt = out->size();
+		out->push_back(0);
+		uint64_t literals = 0;
+		// consecutive non-empty words go into one run
+		while (i < buildings.size() && buildings[i] / 64 == firstWord + literals) {
+			uint64_t bits = 0;
+			uint64_t word = buildings[i] / 64;
+			while (i < buildings.size() && buildings[i] / 64 == word)
+				bits |= (uint64_t)1 << (buildings[i++] % 64);
+			out->push_back(bits);
+			literals++;
+		}
+		(*out)[headerAt] = ((firstWord - nextWord) << 32) | literals;
+		nextWord = firstWord + literals;
+	}
+	out->push_back(0);
+}
+
+
+PotentiallyVisibleSet::PotentiallyVisibleSet()
+	: mapWidth(0), mapDepth(0), buildingCount(0), streetCellCount(0), visibleTotal(0), visibleMaximum(0), buildMs(0.0)
+{
+}
+
+
+/*
+BUILD
+	every worker takes the next street cell:
+	buildings in view distance are sorted by distance from the center of the cell, which is at most SAMPLE_OFFSET
+	from the distance seen from any sample - an occluder is added only when the next building starts farther
+	than all of it even from the worst sample; all buildings occlude, visible to some sample or not
+*/
+void PotentiallyVisibleSet::build(const HeightMap & heightMap, const BuildingTable & buildings, const CityQuadtree & quadtree,
+								  float viewDistance, unsigned int threadCount)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	mapWidth = heightMap.width();
+	mapDepth = heightMap.depth();
+	buildingCount = buildings.count;
+
+	std::vector<unsigned int> cells;
+	for (int z = 0; z < mapDepth; z++) {
+		for (int x = 0; x < mapWidth; x++) {
+			if (heightMap.topHeight(x, z) == 0)
+				cells.push_back((unsigned int)(z * mapWidth + x));
+		}
+	}
+	std::vector<std::vector<uint64_t> > encoded(cells.size());
+	std::vector<unsigned int> visibleCounts(cells.size());
+
+	std::atomic<size_t> nextCell(0);
+	runOnThreads(workerThreadCount(threadCount, 64), [&](unsigned int) {
+		HorizonCulling horizon;
+		std::vector<unsigned int> candidates, visible;
+		std::vector<std::pair<float, unsigned int> > order;
+		std::vector<HorizonFootprint> occluders;
+		std::vector<unsigned char> isVisible;
+		typedef std::pair<float, unsigned int> Pending;
+
+		for (size_t c = nextCell++; c < cells.size(); c = nextCell++) {
+			glm::vec3 cellEye((float)(cells[c] % mapWidth), PVS_EYE_HEIGHT, (float)(cells[c] / mapWidth));
+
+			candidates.clear();
+			quadtree.queryRadius(cellEye, viewDistance + CELL_OFFSET, buildings, &candidates);
+			order.clear();
+			for (size_t i = 0; i < candidates.size(); i++) {
+				HorizonFootprint footprint;
+				HorizonCulling::footprint(cellEye, buildings.center(candidates[i]), buildings.extent(candidates[i]), &footprint);
+				order.push_back(std::make_pair(footprint.nearest, candidates[i]));
+			}
+			std::sort(order.begin(), order.end());
+			isVisible.assign(order.size(), 0);
+			occluders.resize(order.size());
+
+			for (int sample = 0; sample < SAMPLES_PER_SIDE * SAMPLES_PER_SIDE; sample++) {
+				glm::vec3 eye = cellEye + glm::vec3((sample % SAMPLES_PER_SIDE + 0.5f) * SAMPLE_SPACING - 0.5f, 0.0f,
+													(sample / SAMPLES_PER_SIDE + 0.5f) * SAMPLE_SPACING - 0.5f);
+				horizon.clear();
+				std::priority_queue<Pending, std::vector<Pending>, std::greater<Pending> > pending;
+
+				for (size_t k = 0; k < order.size(); k++) {
+					float bound = order[k].first - SAMPLE_OFFSET;
+					while (!pending.empty() && pending.top().first <= bound) {
+						horizon.addOccluder(occluders[pending.top().second]);
+						pending.pop();
+					}
+
+					glm::vec3 center = buildings.center(order[k].second);
+					glm::vec3 extent = buildings.extent(order[k].second);
+					if (!isVisible[k]) {
+						HorizonFootprint footprint;
+						if (!HorizonCulling::footprint(eye, center, extent, &footprint) || !horizon.isHidden(footprint))
+							isVisible[k] = 1;
+					}
+					glm::vec3 shrunk(extent.x - OCCLUDER_SHRINK, extent.y, extent.z - OCCLUDER_SHRINK);
+					if (shrunk.x > 0.0f && shrunk.z > 0.0f && HorizonCulling::footprint(eye, center, shrunk, &occluders[k]))
+						pending.push(std::make_pair(occluders[k].farthest, (unsigned int)k));
+				}
+			}
+
+			visible.clear();
+			for (size_t k = 0; k < order.size(); k++) {
+				if (isVisible[k])
+					visible.push_back(order[k].second);
+			}
+			std::sort(visible.begin(), visible.end());
+			encodeBitset(visible, &encoded[c]);
+			visibleCounts[c] = (unsigned int)visible.size();
+		}
+	});
+
+	// one stream of words, cells without a set have an empty range
+	cellOffsets.assign((size_t)mapWidth * mapDepth + 1, 0);
+	words.clear();
+	streetCellCount = cells.size();
+	visibleTotal = visibleMaximum = 0;
+	size_t c = 0;
+	for (size_t cell = 0; cell < (size_t)mapWidth * mapDepth; cell++) {
+		cellOffsets[cell] = (uint32_t)words.size();
+		if (c < cells.size() && cells[c] == cell) {
+			words.insert(words.end(), encoded[c].begin(), encoded[c].end());
+			visibleTotal += visibleCounts[c];
+			visibleMaximum = std::max(visibleMaximum, (size_t)visibleCounts[c]);
+			c++;
+		}
+	}
+	cellOffsets.back() = (uint32_t)words.size();
+
+	buildMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+
+bool PotentiallyVisibleSet::visibleFrom(const glm::vec3 & eye, std::vector<unsigned int> * visibleBuildings) const
+{
+	int x = HeightMap::cellX(eye.x);
+	int z = HeightMap::cellZ(eye.z);
+	if (!isBuilt() || x < 0 || z < 0 || x >= mapWidth || z >= mapDepth || eye.y > PVS_EYE_HEIGHT)
+		return false;
+	size_t cell = (size_t)z * mapWidth + x;
+	if (cellOffsets[cell] == cellOffsets[cell + 1])
+		return false;
+
+	const uint64_t * word = &words[cellOffsets[cell]];
+	uint64_t firstBuilding = 0;
+	for (uint64_t header = *word++; header != 0; header = *word++) {
+		firstBuilding += (header >> 32) * 64;
+		for (uint64_t literals = header & 0xFFFFFFFF; literals > 0; literals--, firstBuilding += 64) {
+			for (uint64_t bits = *word++; bits != 0; bits &= bits - 1) {
+				unsigned int bit = 0;
+				while (!(bits & ((uint64_t)1 << bit)))
+					bit++;
+				visibleBuildings->push_back((unsigned int)(firstBuilding + bit));
+			}
+		}
+	}
+	return true;
+}
@@ -0,0 +1,68 @@
+#ifndef POTENTIALLY_VISIBLE_SET_H
+#define POTENTIALLY_VISIBLE_SET_H
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include "BuildingTable.h"
+#include "CityQuadtree.h"
+#include "HeightMap.h"
+
+// highest eye over the street the sets are valid for: standing, jumping and the collision tolerance
+const float PVS_EYE_HEIGHT = 0.6f;
+
+/*
+POTENTIALLY VISIBLE SET
+	for every street cell of the grid, the buildings that can be seen from anywhere in it at street level
+	(eye not higher than PVS_EYE_HEIGHT over the street), built once after the city is generated
+
+	a cell is checked from SAMPLES_PER_SIDE x SAMPLES_PER_SIDE eye points with the horizon of HorizonCulling,
+	occluders are shrunk by the distance between an eye in the cell and its nearest sample, so a building
+	hidden from a sample is hidden from every eye around it (occluder shrinking, Wonka et al. 2000);
+	in a height field a lower eye never sees more, so only the highest eye is checked
+
+	sets are bitsets over the building table compressed into runs of 64-bit words:
+		header (number of empty words << 32 | number of literal words), literal words ..., header 0 ends the cell
+*/
+class PotentiallyVisibleSet
+{
+public:
+	static const int SAMPLES_PER_SIDE = 3;
+
+	PotentiallyVisibleSet();
+
+	// buildings have to be in their final order (after CityQuadtree::build), 0 threads - all hardware threads
+	// viewDistance - farthest point the camera sees from its eye (farCornerDistance of the widest field of view)
+	void build(const HeightMap & heightMap, const BuildingTable & buildings, const CityQuadtree & quadtree,
+			   float viewDistance, unsigned int threadCount = 0);
+
+	bool isBuilt() const { return !cellOffsets.empty(); }
+
+	// buildings possibly visible from the eye in ascending order,
+	// false if the set doesn't cover the eye (outside of the city, on a building, above street level)
+	bool visibleFrom(const glm::vec3 & eye, std::vector<unsigned int> * visibleBuildings) const;
+
+	// statistics of the last build
+	size_t streetCells() const { return streetCellCount; }
+	double averageVisible() const { return streetCellCount > 0 ? (double)visibleTotal / streetCellCount : 0.0; }
+	size_t maximumVisible() const { return visibleMaximum; }
+	size_t memoryBytes() const { return words.size() * sizeof(uint64_t) + cellOffsets.size() * sizeof(uint32_t); }
+	size_t uncompressedBytes() const { return streetCellCount * ((buildingCount + 63) / 64) * sizeof(uint64_t); }
+	double buildMilliseconds() const { return buildMs; }
+
+private:
+	int mapWidth;
+	int mapDepth;
+	size_t buildingCount;
+	std::vector<uint32_t> cellOffsets;	// words of cell i: <cellOffsets[i], cellOffsets[i + 1]), empty - no set
+	std::vector<uint64_t> words;
+
+	size_t streetCellCount;
+	size_t visibleTotal;
+	size_t visibleMaximum;
+	double buildMs;
+};
+
+#endif
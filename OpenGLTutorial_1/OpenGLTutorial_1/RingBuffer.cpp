@@ -0,0 +1,138 @@
+#include "RingBuffer.h"
+
+#include <chrono>
+#include <cstring>
+
+// how long one glClientWaitSync may block before it is called again (nanoseconds)
+const GLuint64 FENCE_WAIT_STEP = 1000000;
+
+
+RingBuffer::RingBuffer()
+	: buffer(0), mapped(NULL), regionBytes(0), region(0), offset(0)
+{
+	for (int f = 0; f < FRAMES; f++)
+		fences[f] = NULL;
+	resetStats();
+}
+
+
+void RingBuffer::create(GLsizeiptr frameBytes)
+{
+	allocate(frameBytes);
+	region = 0;
+	offset = 0;
+}
+
+void RingBuffer::allocate(GLsizeiptr frameBytes)
+{
+	regionBytes = frameBytes;
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+	if (glBufferStorage != NULL) {
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_COPY_WRITE_BUFFER, regionBytes * FRAMES, NULL, flags);
+		mapped = (unsigned char *)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, regionBytes * FRAMES, flags);
+	}
+	else {
+		glBufferData(GL_COPY_WRITE_BUFFER, regionBytes * FRAMES, NULL, GL_STREAM_DRAW);
+		mapped = NULL;
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void RingBuffer::release()
+{
+	for (int f = 0; f < FRAMES; f++) {
+		if (fences[f] != NULL)
+			glDeleteSync(fences[f]);
+		fences[f] = NULL;
+	}
+	if (buffer != 0) {
+		if (mapped != NULL) {
+			glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+			glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		}
+		glDeleteBuffers(1, &buffer);
+	}
+	buffer = 0;
+	mapped = NULL;
+}
+
+
+void RingBuffer::beginFrame()
+{
+	region = (region + 1) % FRAMES;
+	offset = 0;
+	GLsync fence = fences[region];
+	if (fence == NULL)
+		return;
+	if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+		auto start = std::chrono::high_resolution_clock::now();
+		GLenum result;
+		do
+			result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_WAIT_STEP);
+		while (result == GL_TIMEOUT_EXPIRED);
+		waitMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		waitCount++;
+	}
+	glDeleteSync(fence);
+	fences[region] = NULL;
+}
+
+GLintptr RingBuffer::write(const void * data, GLsizeiptr bytes, GLsizeiptr alignment)
+{
+	GLsizeiptr aligned = (offset + alignment - 1) / alignment * alignment;
+	if (aligned + bytes > regionBytes) {
+		grow(bytes + alignment);
+		aligned = 0;
+	}
+	wasted += aligned - offset;
+	used += bytes;
+	offset = aligned + bytes;
+
+	GLintptr position = region * regionBytes + aligned;
+	if (mapped != NULL)
+		memcpy(mapped + position, data, bytes);
+	else {
+		glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, position, bytes, data);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	}
+	return position;
+}
+
+void RingBuffer::bindRange(GLenum target, GLuint index, GLintptr position, GLsizeiptr bytes) const
+{
+	glBindBufferRange(target, index, buffer, position, bytes);
+}
+
+void RingBuffer::endFrame()
+{
+	fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+
+/*
+GROW
+	the rest of the frame goes to a new buffer, fences of the old one guard nothing of the new one
+*/
+void RingBuffer::grow(GLsizeiptr atLeast)
+{
+	GLsizeiptr frameBytes = regionBytes * 2;
+	while (frameBytes < atLeast)
+		frameBytes *= 2;
+	wasted += regionBytes - offset;
+	release();
+	allocate(frameBytes);
+	offset = 0;
+	growCount++;
+}
+
+
+void RingBuffer::resetStats()
+{
+	used = wasted = 0;
+	waitCount = growCount = 0;
+	waitMs = 0.0;
+}
@@ -0,0 +1,66 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <glad/glad.h>
+
+#include "GL4Functions.h"
+
+/*
+RING BUFFER
+	one buffer for the data written every frame (model matrices of draws, instance records), split into
+	FRAMES regions used in turns, the frame sub-allocates its data from its region and binds ranges of it,
+	so nothing is orphaned and nothing is allocated by the driver per frame
+	with ARB_buffer_storage the buffer is mapped once (persistent and coherent) and written with memcpy,
+	on GL 3.3 every write is a glBufferSubData of its range
+	the end of a frame puts a fence behind its commands, a region is written again only after its fence
+	(FRAMES - 1 frames later) has passed, so the GPU never reads data being overwritten
+	a frame that doesn't fit into its region moves to a new buffer of twice the size (the old one is
+	released by the driver when the GPU is done with it)
+*/
+class RingBuffer
+{
+public:
+	static const int FRAMES = 3;
+
+	RingBuffer();
+
+	// buffer of FRAMES regions of this size (needs the GL context, loadBufferStorage for the persistent map)
+	void create(GLsizeiptr frameBytes);
+	void release();
+
+	// region of the next frame, waits for the GPU to finish the frame that used it before
+	void beginFrame();
+	// copy of the data in the region of the frame, returns its offset in the buffer (a multiple of alignment)
+	GLintptr write(const void * data, GLsizeiptr bytes, GLsizeiptr alignment);
+	// a written range as a uniform block (GL_UNIFORM_BUFFER) or another indexed binding
+	void bindRange(GLenum target, GLuint index, GLintptr offset, GLsizeiptr bytes) const;
+	// fence behind the commands of the frame
+	void endFrame();
+
+	GLuint getBuffer() const { return buffer; }
+	bool isPersistent() const { return mapped != NULL; }
+
+	// statistics since resetStats
+	GLsizeiptr usedBytes() const { return used; }
+	GLsizeiptr wastedBytes() const { return wasted; }	// alignment padding and regions left by a grow
+	unsigned int waits() const { return waitCount; }		// fences not passed at beginFrame
+	double waitMilliseconds() const { return waitMs; }
+	unsigned int grows() const { return growCount; }
+	void resetStats();
+
+private:
+	void allocate(GLsizeiptr frameBytes);
+	void grow(GLsizeiptr atLeast);
+
+	GLuint buffer;
+	unsigned char * mapped;		// persistent map of the whole buffer, NULL on GL 3.3
+	GLsync fences[FRAMES];
+	GLsizeiptr regionBytes;
+	int region;					// region of the current frame
+	GLsizeiptr offset;			// first free byte of the region
+	GLsizeiptr used, wasted;
+	unsigned int waitCount, growCount;
+	double waitMs;
+};
+
+#endif
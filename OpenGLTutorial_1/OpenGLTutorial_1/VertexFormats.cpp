@@ -0,0 +1,124 @@
+#include "VertexFormats.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdint.h>
+
+static_assert(FloatVertex::Layout::stride == 8 * sizeof(float), "float vertex has to match objectsCoords.cpp");
+static_assert(Packed16Vertex::Layout::stride == 16 && Packed8Vertex::Layout::stride == 12, "unexpected padding of packed vertices");
+
+static const VertexFormat formats[VERTEX_FORMAT_COUNT] = {
+	{ "float", FloatVertex::Layout::stride },
+	{ "packed16", Packed16Vertex::Layout::stride },
+	{ "packed8", Packed8Vertex::Layout::stride }
+};
+
+
+const VertexFormat & getVertexFormat(Vertex_Format format)
+{
+	return formats[format];
+}
+
+bool parseVertexFormat(const char * name, Vertex_Format * format)
+{
+	for (int f = 0; f < VERTEX_FORMAT_COUNT; f++) {
+		if (strcmp(name, formats[f].name) == 0) {
+			*format = (Vertex_Format)f;
+			return true;
+		}
+	}
+	return false;
+}
+
+template <typename Vertex>
+static void setupLayout(bool positionsOnly)
+{
+	if (positionsOnly)
+		Vertex::PositionsOnly::setup();
+	else
+		Vertex::Layout::setup();
+}
+
+void setupVertexFormat(Vertex_Format format, bool positionsOnly)
+{
+	switch (format) {
+	case VERTEX_PACKED16:
+		setupLayout<Packed16Vertex>(positionsOnly);
+		break;
+	case VERTEX_PACKED8:
+		setupLayout<Packed8Vertex>(positionsOnly);
+		break;
+	default:
+		setupLayout<FloatVertex>(positionsOnly);
+		break;
+	}
+}
+
+
+static float maxDifference(const glm::vec4 & a, const glm::vec4 & b)
+{
+	glm::vec4 d = glm::abs(a - b);
+	return std::max(std::max(d.x, d.y), std::max(d.z, d.w));
+}
+
+/*
+PACK
+	every attribute is packed and unpacked again to measure the error
+*/
+bool packMesh(const IndexedMesh & mesh, Vertex_Format format, PackedMesh * packed, float * maxError)
+{
+	if (mesh.floatsPerVertex != 8)
+		return false;
+	const GLsizei stride = formats[format].stride;
+	const GLuint normalOffset = format == VERTEX_PACKED8 ? Packed8Vertex::Layout::offset(1) : Packed16Vertex::Layout::offset(1);
+	const GLuint texCoordsOffset = format == VERTEX_PACKED8 ? Packed8Vertex::Layout::offset(2) : Packed16Vertex::Layout::offset(2);
+	const size_t vertexCount = mesh.vertexCount();
+	packed->format = format;
+	packed->vertexCount = vertexCount;
+	packed->indices = mesh.indices;
+	packed->vertices.resize(vertexCount * stride);
+	if (maxError != NULL)
+		*maxError = 0.0f;
+
+	if (format == VERTEX_FLOAT) {
+		memcpy(packed->vertices.data(), mesh.vertices.data(), mesh.vertices.size() * sizeof(float));
+		return true;
+	}
+
+	float error = 0.0f;
+	for (size_t v = 0; v < vertexCount; v++) {
+		const float * source = mesh.vertices.data() + v * 8;
+		const glm::vec4 position(source[0], source[1], source[2], 0.0f);
+		const glm::vec4 normal(source[3], source[4], source[5], 0.0f);
+		const glm::vec2 texCoords(source[6], source[7]);
+		if (glm::any(glm::greaterThan(glm::abs(position), glm::vec4(1.0f))))
+			return false;
+
+		unsigned char * target = packed->vertices.data() + v * stride;
+		if (format == VERTEX_PACKED16) {
+			glm::uint64 p = glm::packSnorm4x16(position);
+			memcpy(target, &p, sizeof(p));
+			error = std::max(error, maxDifference(glm::unpackSnorm4x16(p), position));
+		}
+		else {
+			glm::uint32 p = glm::packSnorm4x8(position);
+			memcpy(target, &p, sizeof(p));
+			error = std::max(error, maxDifference(glm::unpackSnorm4x8(p), position));
+		}
+
+		glm::uint32 n = glm::packSnorm3x10_1x2(normal);
+		memcpy(target + normalOffset, &n, sizeof(n));
+		error = std::max(error, maxDifference(glm::unpackSnorm3x10_1x2(n), normal));
+
+		glm::uint32 t = glm::packHalf2x16(texCoords);
+		memcpy(target + texCoordsOffset, &t, sizeof(t));
+		error = std::max(error, maxDifference(glm::vec4(glm::unpackHalf2x16(t), 0.0f, 0.0f), glm::vec4(texCoords, 0.0f, 0.0f)));
+	}
+	if (maxError != NULL)
+		*maxError = error;
+	return true;
+}
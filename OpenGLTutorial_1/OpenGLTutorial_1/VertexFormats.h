@@ -0,0 +1,63 @@
+#ifndef VERTEX_FORMATS_H
+#define VERTEX_FORMATS_H
+
+#include <vector>
+
+#include "IndexedMesh.h"
+#include "VertexLayout.h"
+
+/*
+VERTEX FORMATS
+	layouts of the position / normal / texture coords vertex in the vertex buffer:
+		float		3 + 3 + 2 floats, 32 bytes, the layout of objectsCoords.cpp
+		packed16	4 x snorm16 position (w unused), normal in snorm 10_10_10_2, 2 x half float UV, 16 bytes
+		packed8		4 x snorm8 position (w unused), normal in snorm 10_10_10_2, 2 x half float UV, 12 bytes
+	snorm positions only cover <-1, 1>, so only model space meshes (cube, ground, sky) can be packed,
+	8-bit positions are off by up to 1/254 (cubes of a building overlap or leave a gap of that size)
+*/
+enum Vertex_Format {
+	VERTEX_FLOAT,
+	VERTEX_PACKED16,
+	VERTEX_PACKED8,
+	VERTEX_FORMAT_COUNT
+};
+
+// layouts of the formats, PositionsOnly - the same vertex for shaders without lighting and textures
+template <typename Position, typename Normal, typename TexCoords>
+struct MeshVertex {
+	typedef VertexLayout<Position, Normal, TexCoords> Layout;
+	typedef VertexLayout<Position, UnusedBytes<Normal::bytes + TexCoords::bytes> > PositionsOnly;
+};
+typedef MeshVertex<Pos3f, Norm3f, UV2f> FloatVertex;
+typedef MeshVertex<Pos4s16, Norm10_10_10_2, UV2h> Packed16Vertex;
+typedef MeshVertex<Pos4s8, Norm10_10_10_2, UV2h> Packed8Vertex;
+
+struct VertexFormat {
+	const char * name;
+	GLsizei stride;		// bytes of one vertex
+};
+
+const VertexFormat & getVertexFormat(Vertex_Format format);
+// name used by --vertex-format, false if there is no such format
+bool parseVertexFormat(const char * name, Vertex_Format * format);
+
+// attributes of a mesh in the format, the VAO and its vertex buffer have to be bound
+void setupVertexFormat(Vertex_Format format, bool positionsOnly = false);
+
+// indexed mesh converted to one of the formats, ready for glBufferData
+struct PackedMesh {
+	std::vector<unsigned char> vertices;
+	std::vector<unsigned int> indices;
+	Vertex_Format format;
+	size_t vertexCount;
+};
+
+/*
+PACK
+	converts an indexed mesh of 8-float vertices (position, normal, texture coords), the indices are copied,
+	maxError - the biggest difference between a float and its packed value (optional)
+	false if the mesh has another layout or a position outside <-1, 1> and the format is a packed one
+*/
+bool packMesh(const IndexedMesh & mesh, Vertex_Format format, PackedMesh * packed, float * maxError = NULL);
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef VERTEX_LAYOUT_H
+#define VERTEX_LAYOUT_H
+
+#include <glad/glad.h>
+
+#include <cstddef>
+
+/*
+VERTEX LAYOUT
+	attributes of one vertex buffer described by types, the stride and offsets are computed by the compiler:
+		typedef VertexLayout<Pos3f, Norm3f, UV2f> Vertex;	// stride 32, offsets 0, 12, 24
+		Vertex::setup();									// with the VAO and the vertex buffer bound
+	the attribute type carries the shader location, so a layout with a packed position (Pos4s16)
+	feeds the same shaders; bytes the shader doesn't read are skipped with UnusedBytes
+*/
+
+// one glVertexAttribPointer: location in the shader, components, their GL type, normalized integers, bytes in the vertex
+template <GLuint Location, GLint Size, GLenum Type, GLboolean Normalized, GLuint Bytes>
+struct VertexAttribute {
+	static const GLuint location = Location;
+	static const GLuint bytes = Bytes;
+
+	static void enable(GLsizei stride, GLuint offset, GLuint divisor) {
+		glVertexAttribPointer(Location, Size, Type, Normalized, stride, (void*)(size_t)offset);
+		glEnableVertexAttribArray(Location);
+		glVertexAttribDivisor(Location, divisor);
+	}
+};
+
+// part of the vertex not used by the shader (normals and texture coords of the skybox)
+template <GLuint Bytes>
+struct UnusedBytes {
+	static const GLuint bytes = Bytes;
+
+	static void enable(GLsizei, GLuint, GLuint) {}
+};
+
+// locations of lighting_maps.vs, lamp.vs and skybox.vs
+typedef VertexAttribute<0, 3, GL_FLOAT, GL_FALSE, 12> Pos3f;
+typedef VertexAttribute<0, 4, GL_SHORT, GL_TRUE, 8> Pos4s16;		// snorm, w unused
+typedef VertexAttribute<0, 4, GL_BYTE, GL_TRUE, 4> Pos4s8;			// snorm, w unused
+typedef VertexAttribute<1, 3, GL_FLOAT, GL_FALSE, 12> Norm3f;
+typedef VertexAttribute<1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, 4> Norm10_10_10_2;	// snorm, w unused
+typedef VertexAttribute<2, 2, GL_FLOAT, GL_FALSE, 8> UV2f;
+typedef VertexAttribute<2, 2, GL_HALF_FLOAT, GL_FALSE, 4> UV2h;
+
+
+template <typename... Attributes>
+struct VertexLayout;
+
+template <>
+struct VertexLayout<> {
+	static const GLsizei stride = 0;
+
+	static constexpr GLuint offset(unsigned int) { return 0; }
+	static void enable(GLsizei, GLuint, GLuint) {}
+};
+
+template <typename First, typename... Rest>
+struct VertexLayout<First, Rest...> {
+	static const GLsizei stride = First::bytes + VertexLayout<Rest...>::stride;
+
+	// bytes before the attribute with this index
+	static constexpr GLuint offset(unsigned int index) {
+		return index == 0 ? 0 : First::bytes + VertexLayout<Rest...>::offset(index - 1);
+	}
+
+	// attributes of the bound VAO read from the bound GL_ARRAY_BUFFER, divisor 1 - one vertex per instance,
+	// firstByte - where the first vertex starts in the buffer (e.g. a range of a ring buffer)
+	static void setup(GLuint divisor = 0, GLuint firstByte = 0) {
+		enable(stride, firstByte, divisor);
+	}
+
+	static void enable(GLsizei vertexStride, GLuint firstOffset, GLuint divisor) {
+		First::enable(vertexStride, firstOffset, divisor);
+		VertexLayout<Rest...>::enable(vertexStride, firstOffset + First::bytes, divisor);
+	}
+};
+
+#endif
@@ -0,0 +1,73 @@
+#include "WorkerThreads.h"
+
+
+WorkerPool::WorkerPool()
+	: currentJob(NULL), currentWork(NULL), generation(0), running(0), stopping(false)
+{
+}
+
+WorkerPool::~WorkerPool()
+{
+	stop();
+}
+
+
+void WorkerPool::start(unsigned int threadCount)
+{
+	stop();
+	stopping = false;
+	for (unsigned int t = 1; t < threadCount; t++)
+		workers.push_back(std::thread(&WorkerPool::workerLoop, this, t, generation));
+}
+
+void WorkerPool::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (size_t t = 0; t < workers.size(); t++)
+		workers[t].join();
+	workers.clear();
+}
+
+
+void WorkerPool::runJob(Job job, void * work)
+{
+	if (!workers.empty()) {
+		std::lock_guard<std::mutex> lock(mutex);
+		currentJob = job;
+		currentWork = work;
+		running = (unsigned int)workers.size();
+		generation++;
+	}
+	wake.notify_all();
+	job(work, 0);
+	if (!workers.empty()) {
+		std::unique_lock<std::mutex> lock(mutex);
+		finished.wait(lock, [this] { return running == 0; });
+	}
+}
+
+// done - the generation before the first job of the worker (a job can start before the thread does)
+void WorkerPool::workerLoop(unsigned int thread, unsigned int done)
+{
+	for (;;) {
+		Job job;
+		void * work;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [this, done] { return stopping || generation != done; });
+			if (stopping)
+				return;
+			done = generation;
+			job = currentJob;
+			work = currentWork;
+		}
+		job(work, thread);
+		std::lock_guard<std::mutex> lock(mutex);
+		if (--running == 0)
+			finished.notify_one();
+	}
+}
@@ -0,0 +1,74 @@
+#ifndef WORKER_THREADS_H
+#define WORKER_THREADS_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 0 - one thread per hardware thread, the result is always in <1, maximum>
+inline unsigned int workerThreadCount(unsigned int requested, unsigned int maximum)
+{
+	unsigned int threads = requested;
+	if (threads == 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	return std::max(1u, std::min(threads, maximum));
+}
+
+// work(0) runs on the calling thread, work(1 .. threadCount - 1) on new ones, returns when all are done
+template <typename Work>
+void runOnThreads(unsigned int threadCount, Work work)
+{
+	std::vector<std::thread> workers;
+	for (unsigned int t = 1; t < threadCount; t++)
+		workers.push_back(std::thread(work, t));
+	work(0);
+	for (size_t t = 0; t < workers.size(); t++)
+		workers[t].join();
+}
+
+/*
+WORKER POOL
+	threads made once and kept asleep between jobs, for work repeated every frame
+	(runOnThreads makes new threads on every call, fine for work done once at load)
+	run(work) - work(0) on the calling thread, work(1 .. threadCount - 1) on the workers, returns when all are done
+*/
+class WorkerPool
+{
+public:
+	WorkerPool();
+	~WorkerPool();
+
+	// threadCount - 1 workers are made (the calling thread is the first one), the old ones are stopped
+	void start(unsigned int threadCount);
+	void stop();
+	unsigned int threadCount() const { return (unsigned int)workers.size() + 1; }
+
+	template <typename Work>
+	void run(Work & work) { runJob(&callWork<Work>, &work); }
+
+private:
+	typedef void (*Job)(void * work, unsigned int thread);
+
+	template <typename Work>
+	static void callWork(void * work, unsigned int thread) { (*static_cast<Work *>(work))(thread); }
+
+	void runJob(Job job, void * work);
+	void workerLoop(unsigned int thread, unsigned int done);
+
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable wake;		// a new job or stop
+	std::condition_variable finished;	// the last worker is done with the job
+	Job currentJob;
+	void * currentWork;
+	unsigned int generation;			// number of jobs so far, a worker runs every generation once
+	unsigned int running;				// workers still busy with the current job
+	bool stopping;
+
+	WorkerPool(const WorkerPool &);
+	WorkerPool & operator=(const WorkerPool &);
+};
+
+#endif
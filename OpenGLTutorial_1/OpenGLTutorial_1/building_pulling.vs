@@ -0,0 +1,57 @@
+#version 330 core
+// vertex pulling of buildings (BuildingPulling): no vertex attributes, gl_VertexID picks the corner
+// of the box (verticesTab3 order), gl_InstanceID the record of the building in the texture buffer
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoords;
+invariant gl_Position;             // the same depth in the depth pre-pass (depth_only.fs) and the shading pass
+
+uniform usamplerBuffer buildings;  // x 12 bits, z 12 bits, floors 6 bits, level 2 bits
+uniform int firstBuilding;         // first record of the drawn level
+uniform mat4 view;
+uniform mat4 projection;
+
+const vec3 corners[36] = vec3[36](
+    vec3(-0.5, -0.5, -0.5), vec3(0.5, 0.5, -0.5), vec3(0.5, -0.5, -0.5), vec3(0.5, 0.5, -0.5), vec3(-0.5, -0.5, -0.5), vec3(-0.5, 0.5, -0.5),
+    vec3(-0.5, -0.5, 0.5), vec3(0.5, -0.5, 0.5), vec3(0.5, 0.5, 0.5), vec3(0.5, 0.5, 0.5), vec3(-0.5, 0.5, 0.5), vec3(-0.5, -0.5, 0.5),
+    vec3(-0.5, 0.5, 0.5), vec3(-0.5, 0.5, -0.5), vec3(-0.5, -0.5, -0.5), vec3(-0.5, -0.5, -0.5), vec3(-0.5, -0.5, 0.5), vec3(-0.5, 0.5, 0.5),
+    vec3(0.5, 0.5, 0.5), vec3(0.5, -0.5, -0.5), vec3(0.5, 0.5, -0.5), vec3(0.5, -0.5, -0.5), vec3(0.5, 0.5, 0.5), vec3(0.5, -0.5, 0.5),
+    vec3(-0.5, -0.5, -0.5), vec3(0.5, -0.5, -0.5), vec3(0.5, -0.5, 0.5), vec3(0.5, -0.5, 0.5), vec3(-0.5, -0.5, 0.5), vec3(-0.5, -0.5, -0.5),
+    vec3(-0.5, 0.5, -0.5), vec3(0.5, 0.5, 0.5), vec3(0.5, 0.5, -0.5), vec3(0.5, 0.5, 0.5), vec3(-0.5, 0.5, -0.5), vec3(-0.5, 0.5, 0.5)
+);
+
+const vec2 texCoords[36] = vec2[36](
+    vec2(0.0, 0.0), vec2(1.0, 1.0), vec2(1.0, 0.0), vec2(1.0, 1.0), vec2(0.0, 0.0), vec2(0.0, 1.0),
+    vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(1.0, 1.0), vec2(1.0, 1.0), vec2(0.0, 1.0), vec2(0.0, 0.0),
+    vec2(1.0, 0.0), vec2(1.0, 1.0), vec2(0.0, 1.0), vec2(0.0, 1.0), vec2(0.0, 0.0), vec2(1.0, 0.0),
+    vec2(1.0, 0.0), vec2(0.0, 1.0), vec2(1.0, 1.0), vec2(0.0, 1.0), vec2(1.0, 0.0), vec2(0.0, 0.0),
+    vec2(0.0, 1.0), vec2(1.0, 1.0), vec2(1.0, 0.0), vec2(1.0, 0.0), vec2(0.0, 0.0), vec2(0.0, 1.0),
+    vec2(0.0, 1.0), vec2(1.0, 0.0), vec2(1.0, 1.0), vec2(1.0, 0.0), vec2(0.0, 1.0), vec2(0.0, 0.0)
+);
+
+// one normal per face (6 vertices)
+const vec3 normals[6] = vec3[6](
+    vec3(0.0, 0.0, -1.0), vec3(0.0, 0.0, 1.0), vec3(-1.0, 0.0, 0.0),
+    vec3(1.0, 0.0, 0.0), vec3(0.0, -1.0, 0.0), vec3(0.0, 1.0, 0.0)
+);
+
+void main()
+{
+    uint record = texelFetch(buildings, firstBuilding + gl_InstanceID).r;
+    vec2 cell = vec2(float(record & 0xfffu), float((record >> 12) & 0xfffu));
+    float floors = float((record >> 24) & 0x3fu);
+
+    // the unit cube stretched over all floors, walls repeat their texture once per floor
+    int face = gl_VertexID / 6;
+    vec3 corner = corners[gl_VertexID];
+    FragPos = vec3(cell.x + corner.x, (corner.y + 0.5) * floors - 0.5, cell.y + corner.z);
+    Normal = normals[face];
+    TexCoords = texCoords[gl_VertexID];
+    if (face < 2)
+        TexCoords.y *= floors;
+    else if (face < 4)
+        TexCoords.x *= floors;
+
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
\ No newline at end of file
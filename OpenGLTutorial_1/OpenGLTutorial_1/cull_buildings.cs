@@ -0,0 +1,87 @@
+#version 430 core
+// GPU culling of buildings (GpuCulling): one invocation per building record, a box inside the frustum
+// and not behind the depth pyramid is appended to the visible records of its texture level, the slot
+// comes from atomicAdd on the instance count of the level's draw commands
+
+layout(local_size_x = 64) in;
+
+struct DrawArraysIndirectCommand {
+    uint count;
+    uint instanceCount;
+    uint first;
+    uint baseInstance;
+};
+
+layout(std430, binding = 0) readonly buffer Buildings { uint buildings[]; };   // x 12 bits, z 12 bits, floors 6 bits, level 2 bits
+layout(std430, binding = 1) writeonly buffer Visible { uint visible[]; };      // levels one after another
+layout(std430, binding = 2) buffer Commands { DrawArraysIndirectCommand commands[]; };  // level * 3 + face pair
+
+uniform int buildingCount;
+uniform int firstBuilding[4];           // first visible record of the level
+uniform vec4 planes[6];                 // frustum (FrustumCulling), inside when dot(plane.xyz, p) + plane.w >= 0
+uniform bool useDepthPyramid;
+uniform mat4 pyramidViewProjection;     // camera of the frame the pyramid was built from
+uniform vec2 depthSize;                 // pixels of the depth buffer under the pyramid
+uniform sampler2D depthPyramid;         // farthest depth, level 0 is half of the depth buffer
+
+bool isBoxVisible(vec3 center, vec3 extent)
+{
+    for (int i = 0; i < 6; i++)
+        if (dot(planes[i].xyz, center) + planes[i].w + dot(abs(planes[i].xyz), extent) < 0.0)
+            return false;
+    return true;
+}
+
+bool isBoxOccluded(vec3 boxMin, vec3 boxMax)
+{
+    vec3 ndcMin = vec3(1e30), ndcMax = vec3(-1e30);
+    for (int i = 0; i < 8; i++) {
+        vec3 corner = mix(boxMin, boxMax, vec3(i & 1, (i >> 1) & 1, (i >> 2) & 1));
+        vec4 clip = pyramidViewProjection * vec4(corner, 1.0);
+        if (clip.w <= 0.0)   // reaches behind the camera of the pyramid
+            return false;
+        ndcMin = min(ndcMin, clip.xyz / clip.w);
+        ndcMax = max(ndcMax, clip.xyz / clip.w);
+    }
+    // the pyramid knows nothing outside its screen
+    if (ndcMax.x < -1.0 || ndcMin.x > 1.0 || ndcMax.y < -1.0 || ndcMin.y > 1.0)
+        return false;
+
+    // pixels of the depth buffer under the box, the level where they span at most 2 x 2 texels
+    vec2 pixelMin = clamp(ndcMin.xy * 0.5 + 0.5, 0.0, 1.0) * depthSize;
+    vec2 pixelMax = clamp(ndcMax.xy * 0.5 + 0.5, 0.0, 1.0) * depthSize;
+    vec2 size = pixelMax - pixelMin;
+    int level = max(int(ceil(log2(max(max(size.x, size.y), 1.0)))) - 1, 0);
+    if (level >= textureQueryLevels(depthPyramid))
+        return false;
+
+    ivec2 last = textureSize(depthPyramid, level) - 1;
+    ivec2 texelMin = min(ivec2(pixelMin) >> (level + 1), last);
+    ivec2 texelMax = min(ivec2(min(pixelMax, depthSize - 1.0)) >> (level + 1), last);
+    float farthest = max(max(texelFetch(depthPyramid, texelMin, level).r, texelFetch(depthPyramid, ivec2(texelMax.x, texelMin.y), level).r),
+                         max(texelFetch(depthPyramid, ivec2(texelMin.x, texelMax.y), level).r, texelFetch(depthPyramid, texelMax, level).r));
+    return ndcMin.z * 0.5 + 0.5 > farthest;
+}
+
+void main()
+{
+    int id = int(gl_GlobalInvocationID.x);
+    if (id >= buildingCount)
+        return;
+    uint record = buildings[id];
+    float floors = float((record >> 24) & 0x3fu);
+
+    // the box of building_pulling.vs: the unit cube stretched over all floors
+    vec3 center = vec3(float(record & 0xfffu), floors * 0.5 - 0.5, float((record >> 12) & 0xfffu));
+    vec3 extent = vec3(0.5, floors * 0.5, 0.5);
+    if (!isBoxVisible(center, extent))
+        return;
+    if (useDepthPyramid && isBoxOccluded(center - extent, center + extent))
+        return;
+
+    int level = int(record >> 30);
+    uint slot = atomicAdd(commands[level * 3].instanceCount, 1u);
+    atomicAdd(commands[level * 3 + 1].instanceCount, 1u);
+    atomicAdd(commands[level * 3 + 2].instanceCount, 1u);
+    visible[firstBuilding[level] + int(slot)] = record;
+}
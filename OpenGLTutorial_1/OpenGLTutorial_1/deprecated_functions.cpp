@@ -85,3 +85,94 @@ float timeValue = glfwGetTime();
 float greenValue = sin(timeValue) / 2.0f + 0.5f;
 int vertexColorLocation = glGetUniformLocation(shaderProgram, "ourColor");
 glUniform4f(vertexColorLocation, 0.5f, greenValue, greenValue/2, 1.0f);
+
+
+/*
+VBO:	create / bind and select type / configure
+VAO:	create / bind (connects to VBO)
+EBO:	create / bind (connects to VAO and VBO) / configure (for using indices)
+*/
+void configureVAO_VBO_EBO(unsigned int * VAO, unsigned int * VBO, unsigned int * EBO) {
+	// always add '*' before each parameter
+	glGenVertexArrays(1, *&VAO);  // xd
+	glGenBuffers(1, *&VBO);
+	//glGenBuffers(1, &EBO);
+
+	glBindBuffer(GL_ARRAY_BUFFER, *VBO);
+	glBufferData(GL_ARRAY_BUFFER, buildingMeshSize, buildingMesh, GL_STATIC_DRAW);
+	glBindVertexArray(*VAO);
+
+	//glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+	//glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+}
+
+
+/*
+	VAO - vertex array object creation
+*/
+void configureAnotherVAO(unsigned int * VAO, const void * verticesTab, size_t verticesSize) {
+	// always add '*' before each parameter
+	glGenVertexArrays(1, *&VAO);  // xd
+	glBindVertexArray(*VAO);
+	glBufferData(GL_ARRAY_BUFFER, verticesSize, verticesTab, GL_STATIC_DRAW);
+}
+
+
+/*
+	clear and delete VAO VBO EBO
+*/
+void cleanVAO_VBO_EBO(unsigned int * VAO, unsigned int * VBO, unsigned int * EBO) {
+	glDeleteVertexArrays(1, *&VAO);
+	glDeleteBuffers(1, *&VBO);
+	//glDeleteBuffers(1, &EBO);
+}
+
+
+/*
+set how OpenGL should interpret objectCoords.cpp data
+*/
+void howInterpretVertexData(GLuint sizeOfRow, GLuint vertexCoordsNumber,
+							GLuint normalCoordsNumber, GLuint textureCoordsNumber) {
+	// position attribute:
+	// 0 - attribute location, 3 - number of vertex coords, 5* - size of row
+	//glVertexAttribPointer(0, vertexCoordsNumber, GL_FLOAT, GL_FALSE, sizeOfRow * sizeof(float), (void*)0);
+	glVertexAttribPointer(0, vertexCoordsNumber, GL_FLOAT, GL_FALSE, sizeOfRow * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+
+	// normal attribute
+	// 1 - attribute location, 3 - number of vertex coords, 8* - size of row
+	//glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+	//glEnableVertexAttribArray(1);
+
+	// texture coord attribute
+	// 1 - attribute location, 2 - number of vertex coords, 5* - size of row, 3* - offset
+	//glVertexAttribPointer(1, textureCoordsNumber, GL_FLOAT, GL_FALSE, sizeOfRow * sizeof(float), (void*)(3 * sizeof(float)));
+	glVertexAttribPointer(1, textureCoordsNumber, GL_FLOAT, GL_FALSE, sizeOfRow * sizeof(float), (void*)(3 * sizeof(float)));
+	glEnableVertexAttribArray(1);
+}
+
+
+
+/*
+set how OpenGL should interpret objectCoords.cpp data
+*/
+void howInterpretVertexData(GLuint sizeOfRow, GLuint vertexCoordsNumber,
+	GLuint normalCoordsNumber, GLuint textureCoordsNumber,
+	GLuint vertexOffset, GLuint normalOffset, GLuint textureOffset) {
+	// position attribute:
+	// 0 - attribute location, 3 - number of vertex coords, 5* - size of row
+	//glVertexAttribPointer(0, vertexCoordsNumber, GL_FLOAT, GL_FALSE, sizeOfRow * sizeof(float), (void*)0);
+	glVertexAttribPointer(0, vertexCoordsNumber, GL_FLOAT, GL_FALSE, sizeOfRow * sizeof(float), (void*)vertexOffset);
+	glEnableVertexAttribArray(0);
+
+	// normal attribute
+	// 1 - attribute location, 3 - number of vertex coords, 8* - size of row
+	glVertexAttribPointer(1, normalCoordsNumber, GL_FLOAT, GL_FALSE, sizeOfRow * sizeof(float), (void*)(normalOffset * sizeof(float)));
+	glEnableVertexAttribArray(1);
+
+	// texture coord attribute
+	// 1 - attribute location, 2 - number of vertex coords, 5* - size of row, 3* - offset
+	//glVertexAttribPointer(1, textureCoordsNumber, GL_FLOAT, GL_FALSE, sizeOfRow * sizeof(float), (void*)(3 * sizeof(float)));
+	glVertexAttribPointer(2, textureCoordsNumber, GL_FLOAT, GL_FALSE, sizeOfRow * sizeof(float), (void*)(textureOffset * sizeof(float)));
+	glEnableVertexAttribArray(2);
+}
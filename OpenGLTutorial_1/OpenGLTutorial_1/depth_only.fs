@@ -0,0 +1,6 @@
+#version 330 core
+// depth pre-pass: no color output, only the depth test and depth writes of the fragments
+
+void main()
+{
+}
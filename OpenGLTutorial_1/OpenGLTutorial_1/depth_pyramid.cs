@@ -0,0 +1,34 @@
+#version 430 core
+// one level of the depth pyramid (GpuCulling): a texel is the farthest depth of the 2 x 2 texels under it
+// in the level before (the depth buffer for level 0), the last row / column of an odd size is taken by
+// the last texel, so every pixel of the depth buffer is under a texel of every level
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+uniform sampler2D depth;                            // depth buffer of the frame
+uniform bool fromDepth;                             // level 0
+layout(binding = 0, r32f) readonly uniform image2D source;          // level before
+layout(binding = 1, r32f) writeonly uniform image2D destination;
+
+float sourceDepth(ivec2 texel)
+{
+    return fromDepth ? texelFetch(depth, texel, 0).r : imageLoad(source, texel).r;
+}
+
+void main()
+{
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = imageSize(destination);
+    if (texel.x >= size.x || texel.y >= size.y)
+        return;
+    ivec2 sourceSize = fromDepth ? textureSize(depth, 0) : imageSize(source);
+
+    ivec2 first = texel * 2;
+    ivec2 last = first + 1 + ivec2(equal(texel, size - 1)) * (sourceSize - size * 2);
+    last = min(last, sourceSize - 1);
+    float farthest = 0.0;
+    for (int y = first.y; y <= last.y; y++)
+        for (int x = first.x; x <= last.x; x++)
+            farthest = max(farthest, sourceDepth(ivec2(x, y)));
+    imageStore(destination, texel, vec4(farthest));
+}
@@ -0,0 +1,15 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D atlas;
+
+void main()
+{
+    // views are captured on a transparent background
+    vec4 color = texture(atlas, TexCoords);
+    if (color.a < 0.5)
+        discard;
+    FragColor = vec4(color.rgb, 1.0);
+}
\ No newline at end of file
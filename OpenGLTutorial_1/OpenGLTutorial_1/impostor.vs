@@ -0,0 +1,41 @@
+#version 330 core
+layout (location = 0) in vec2 aCorner;
+layout (location = 1) in vec4 aSphere;  // per instance: center, radius
+layout (location = 2) in float aTile;   // per instance: archetype in the atlas
+
+out vec2 TexCoords;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec3 viewPos;
+uniform float frames;        // views per side of an archetype tile
+uniform float tilesPerSide;  // tiles per side of the atlas
+
+// upper hemisphere folded into the unit square, the same as ImpostorAtlas
+vec2 encodeDirection(vec3 d)
+{
+    d.y = max(d.y, 0.0);
+    vec2 p = d.xz / (abs(d.x) + abs(d.y) + abs(d.z));
+    return vec2(p.x + p.y, p.x - p.y) * 0.5 + 0.5;
+}
+
+vec3 decodeDirection(vec2 position)
+{
+    vec2 square = position * 2.0 - 1.0;
+    vec2 p = vec2(square.x + square.y, square.x - square.y) * 0.5;
+    return normalize(vec3(p.x, 1.0 - abs(p.x) - abs(p.y), p.y));
+}
+
+void main()
+{
+    // nearest captured view, the quad faces the camera of that view (lookAt basis of the capture)
+    vec2 frame = min(floor(encodeDirection(normalize(viewPos - aSphere.xyz)) * frames), vec2(frames - 1.0));
+    vec3 direction = decodeDirection((frame + 0.5) / frames);
+    vec3 right = normalize(cross(vec3(0.0, 1.0, 0.0), direction));
+    vec3 up = cross(direction, right);
+    vec3 position = aSphere.xyz + (right * aCorner.x + up * aCorner.y) * aSphere.w;
+
+    vec2 tile = vec2(mod(aTile, tilesPerSide), floor(aTile / tilesPerSide));
+    TexCoords = (tile * frames + frame + aCorner * 0.5 + 0.5) / (frames * tilesPerSide);
+    gl_Position = projection * view * vec4(position, 1.0);
+}
@@ -0,0 +1,23 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+layout (location = 3) in vec4 aInstance;  // per draw (IndirectDraws): position, w = 1 - ground tile
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoords;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+    // ground tiles are turned by -90 degrees around x (the quad of objectsCoords stands on z)
+    mat3 turn = aInstance.w > 0.5 ? mat3(1.0, 0.0, 0.0, 0.0, 0.0, -1.0, 0.0, 1.0, 0.0) : mat3(1.0);
+    FragPos = turn * aPos + aInstance.xyz;
+    Normal = turn * aNormal;
+    TexCoords = aTexCoords;
+
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
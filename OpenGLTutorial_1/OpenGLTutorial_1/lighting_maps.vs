@@ -7,7 +7,10 @@ out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoords;
 
-uniform mat4 model;
+// model matrix of the draw, a range of the ring buffer of per-frame data
+layout (std140) uniform Draw {
+    mat4 model;
+};
 uniform mat4 view;
 uniform mat4 projection;
 
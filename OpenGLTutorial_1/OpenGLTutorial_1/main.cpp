@@ -14,6 +14,30 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include "objectsCoords.h"
+#include "CitySnapshot.h"
+#include "CityGenerator.h"
+#include "HeightMap.h"
+#include "Benchmark.h"
+#include "FrameStats.h"
+#include "BuildingTable.h"
+#include "FrustumCulling.h"
+#include "CityQuadtree.h"
+#include "HorizonCulling.h"
+#include "OcclusionCulling.h"
+#include "OcclusionQueries.h"
+#include "PotentiallyVisibleSet.h"
+#include "CityLod.h"
+#include "ImpostorAtlas.h"
+#include "IndexedMesh.h"
+#include "VertexFormats.h"
+#include "BuildingPulling.h"
+#include "GpuCulling.h"
+#include "RingBuffer.h"
+#include "GeometryArena.h"
+#include "DrawOrder.h"
+#include "PipelineStatistics.h"
+#include "FaceDirections.h"
+#include "IndirectDraws.h"
 
 // classes
 #include "Shader.h"
@@ -42,11 +66,84 @@ float lastX = SCR_WIDTH / 2.0f;
 float lastY = SCR_HEIGHT / 2.0f;
 bool firstMouse = true;
 
-float deltaTime = 0.0f;	// time between current frame and last frame
-float lastFrame = 0.0f;
+// fixed-rate simulation, rendering interpolates between the last two simulation steps
+const double SIMULATION_STEP = 1.0 / 120.0;	// seconds of one physics step
+const double MAX_FRAME_TIME = 0.25;			// longer frames are clamped, so simulation can catch up
+float deltaTime = (float)SIMULATION_STEP;	// time of one simulation step, used by input and movement
+double lastFrame = 0.0;
+double accumulator = 0.0;					// simulation time not consumed by steps yet
+
+// per-frame measurements printed to the console
+FrameStats frameStats;
 
 glm::vec3 lightPos(-1.0f, 7.0f, -1.0f);
 
+// meshes of buildings and ground (replaced by baked meshes when a snapshot is loaded)
+const float * buildingMesh = verticesTab3;
+size_t buildingMeshSize = verticesSize3;
+const float * groundMesh = verticesTab2;
+size_t groundMeshSize = verticesSize2;
+
+/*
+COMMAND LINE
+	--seed N			seed of std::rand used by the city generator (default: current time)
+	--size N			size of city, number of cells on X and Z axis
+	--save-city FILE	write the generated city to a snapshot file
+	--load-city FILE	map the city from a snapshot file instead of generating it
+	--bench NAME		run a CPU benchmark (see Benchmark.h) and exit
+	--pvs				build potentially visible sets of street cells at load
+	--vertex-format F	layout of the cube, ground and sky vertices: float, packed16 (default), packed8
+	--gpu-culling		start with buildings culled by the compute shader (GL 4.3)
+*/
+struct Options {
+	unsigned int seed;
+	int sizeOfCity;
+	const char * saveCity;
+	const char * loadCity;
+	const char * bench;
+	bool pvs;
+	Vertex_Format vertexFormat;
+	bool gpuCulling;
+};
+
+Options parseOptions(int argc, char * argv[]) {
+	Options options;
+	options.seed = (unsigned int)time(NULL);
+	options.sizeOfCity = camera.sizeOfCity;
+	options.saveCity = NULL;
+	options.loadCity = NULL;
+	options.bench = NULL;
+	options.pvs = false;
+	options.vertexFormat = VERTEX_PACKED16;
+	options.gpuCulling = false;
+
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "--seed" && hasValue)
+			options.seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+		else if (arg == "--size" && hasValue)
+			options.sizeOfCity = atoi(argv[++i]);
+		else if (arg == "--save-city" && hasValue)
+			options.saveCity = argv[++i];
+		else if (arg == "--load-city" && hasValue)
+			options.loadCity = argv[++i];
+		else if (arg == "--bench" && hasValue)
+			options.bench = argv[++i];
+		else if (arg == "--pvs")
+			options.pvs = true;
+		else if (arg == "--vertex-format" && hasValue) {
+			if (!parseVertexFormat(argv[++i], &options.vertexFormat))
+				std::cout << "Unknown vertex format: " << argv[i] << std::endl;
+		}
+		else if (arg == "--gpu-culling")
+			options.gpuCulling = true;
+		else
+			std::cout << "Unknown option: " << arg << std::endl;
+	}
+	return options;
+}
+
 /*
 GLFW
 	initialize
@@ -172,267 +269,286 @@ unsigned int loadCubemap(std::vector<std::string> faces)
 
 
 /*
-generate cubes
-	choose position on Z-axis, X-axis on area
-	take random number as height of the building (Y-axis)
-	create cube and pass it on to the vector of vec3
+LIGHTING
+	lamp and material of lightingShader, the same for the city and the impostor capture
 */
-void generateCity( std::vector<glm::vec4>* cubePositions, int sizeOfCity){
-	for (int k = 0; k < sizeOfCity; k++) { // z
-		if (k % 2 == 0) {
-			for (int j = 0; j < sizeOfCity; j++) {  // x
-				if (j % 2 == 0) {
-					int height = 4;
-					int lowest = 2;
-					int buildingHeight = std::rand() % height + lowest; // <lowest, lowest+height>
-					float texture = 0.0f;
-						if (buildingHeight % height == 1) {
-							texture = 1.0f;
-						}
-						else if (buildingHeight % height == 2) {
-							texture = 2.0f;
-						}
-						else if (buildingHeight % height == 3) {
-							texture = 3.0f;
-						}
-						else {
-							texture = 0.0f;
-						}
-					for (int i = 0; i < buildingHeight; i++) {  // y
-						cubePositions->push_back(glm::vec4((float)j, (float)i, (float)k, texture));
-					}
-				}
-			}
-		}
-	}
+void setLighting(const Shader & shader, const glm::vec3 & lightPosition, const glm::vec3 & viewPosition) {
+	shader.use();
+	shader.setVec3("light.position", lightPosition);
+	shader.setVec3("viewPos", viewPosition);
+	// light properties
+	shader.setVec3("light.ambient", 0.2f, 0.2f, 0.2f);
+	shader.setVec3("light.diffuse", 1.0f, 1.0f, 1.0f);
+	shader.setVec3("light.specular", 1.0f, 1.0f, 1.0f);
+	// material properties
+	shader.setVec3("material.specular", 0.5f, 0.5f, 0.5f);
+	shader.setFloat("material.shininess", 32.0f);
 }
 
 
+// per-frame data of draws (model matrices, impostor instances), written between beginFrame and endFrame
+RingBuffer frameData;
+const GLsizeiptr FRAME_DATA_BYTES = 1 << 20;	// first size of a frame, the ring grows when a frame needs more
+GLint uniformAlignment = 256;					// GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT of the context
+const GLuint DRAW_BLOCK = 0;					// binding of the Draw uniform block of lighting_maps.vs
+const GLint BUILDINGS_UNIT = 2;					// texture unit of the records of building_pulling.vs (0 and 1 - material)
+
 /*
-generate flat street crossings
-	choose position on Z-axis, X-axis on area
-	Y-axis always 0 (ground level)
-	create square and pass it on to the vector of vec3
+MODEL
+	model matrix of the next draws of lighting_maps.vs, written to the ring buffer
+	and bound as the range of the Draw uniform block
 */
-void generateCrossings(std::vector<glm::vec3>* streetPositions, int sizeOfCity) {
-	for (int k = 0; k < sizeOfCity; k++) { // z
-		if (k % 2 != 0) {
-			for (int j = 0; j < sizeOfCity; j++) {  // x
-				if (j % 2 != 0) {
-						streetPositions->push_back(glm::vec3((float)j, 0.0f, (float)k));
-				}
-			}
-		}
-	}
+void setModel(const glm::mat4 & model) {
+	GLintptr offset = frameData.write(&model[0][0], sizeof(glm::mat4), uniformAlignment);
+	frameData.bindRange(GL_UNIFORM_BUFFER, DRAW_BLOCK, offset, sizeof(glm::mat4));
 }
 
 
 /*
-generate flat street 
-choose position on Z-axis, X-axis on area
-Y-axis always 0 (ground level)
-create square and pass it on to the vector of vec3
+CUBE
+	one floor of a building, textures of its level: front + back, left + right, bottom + top
+	(indices of the building mesh have the faces in this order), the VAO of the mesh and lightingShader have to be bound
+	faces - mask of Face_Direction bits, the rest is not drawn
 */
-void generateStreet(std::vector<glm::vec3>* streetPositions, int sizeOfCity) {
-	for (int k = 0; k < sizeOfCity; k++) { // z
-		if (k % 2 == 0) {
-			for (int j = 0; j < sizeOfCity; j++) {  // x
-				if (j % 2 != 0) {
-					streetPositions->push_back(glm::vec3((float)j, 0.0f, (float)k));
-				}
-			}
-		}
+void drawCube(const glm::vec3 & position, const unsigned int textures[3], unsigned int faces = ALL_FACES) {
+	glm::mat4 model;
+	model = glm::translate(model, position);
+	setModel(model);
+	glState.activeTexture(GL_TEXTURE0);
+	for (int face = 0; face < FACE_COUNT; face++) {
+		if (!(faces & (1u << face)))
+			continue;
+		glState.bindTexture(GL_TEXTURE_2D, textures[face / 2]);
+		glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)(face * 6 * sizeof(unsigned int)));
 	}
 }
 
 
 /*
-generate flat street
-choose position on Z-axis, X-axis on area
-Y-axis always 0 (ground level)
-create square and pass it on to the vector of vec3
+MESH BUFFERS
+	VAO, vertex and index buffer of an indexed mesh (position, normal, texture coords), kept for the whole run
+	the mesh is converted to the vertex format first, meshes that can't be packed stay in floats,
+	positionsOnly - only the position attribute is enabled (skybox)
 */
-void generateStreet2(std::vector<glm::vec3>* streetPositions, int sizeOfCity) {
-	for (int k = 0; k < sizeOfCity; k++) { // z
-		if (k % 2 != 0) {
-			for (int j = 0; j < sizeOfCity; j++) {  // x
-				if (j % 2 == 0) {
-					streetPositions->push_back(glm::vec3((float)j, 0.0f, (float)k));
-				}
-			}
-		}
+struct MeshBuffers {
+	unsigned int VAO, VBO, EBO;
+	GLsizei indexCount;
+};
+
+MeshBuffers uploadMesh(const char * name, const IndexedMesh & mesh, Vertex_Format format, bool positionsOnly = false) {
+	PackedMesh packed;
+	float maxError = 0.0f;
+	if (!packMesh(mesh, format, &packed, &maxError)) {
+		std::cout << "Mesh " << name << " can't be packed to " << getVertexFormat(format).name << ", it stays in floats" << std::endl;
+		packMesh(mesh, VERTEX_FLOAT, &packed);
 	}
+	else if (format != VERTEX_FLOAT)
+		std::cout << "Mesh " << name << " packed to " << getVertexFormat(format).name << ", max error " << maxError << std::endl;
+
+	MeshBuffers buffers;
+	glGenVertexArrays(1, &buffers.VAO);
+	glGenBuffers(1, &buffers.VBO);
+	glGenBuffers(1, &buffers.EBO);
+	glBindVertexArray(buffers.VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, buffers.VBO);
+	glBufferData(GL_ARRAY_BUFFER, packed.vertices.size(), packed.vertices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.EBO);	// stays bound to the VAO
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, packed.indices.size() * sizeof(unsigned int), packed.indices.data(), GL_STATIC_DRAW);
+	setupVertexFormat(packed.format, positionsOnly);
+	buffers.indexCount = (GLsizei)packed.indices.size();
+	return buffers;
 }
 
+void releaseMesh(const MeshBuffers & buffers) {
+	glDeleteVertexArrays(1, &buffers.VAO);
+	glDeleteBuffers(1, &buffers.VBO);
+	glDeleteBuffers(1, &buffers.EBO);
+}
 
-/*
-VBO:	create / bind and select type / configure
-VAO:	create / bind (connects to VBO)
-EBO:	create / bind (connects to VAO and VBO) / configure (for using indices)
-*/
-void configureVAO_VBO_EBO(unsigned int * VAO, unsigned int * VBO, unsigned int * EBO) {
-	// always add '*' before each parameter
-	glGenVertexArrays(1, *&VAO);  // xd
-	glGenBuffers(1, *&VBO);
-	//glGenBuffers(1, &EBO);
-
-	glBindBuffer(GL_ARRAY_BUFFER, *VBO);
-	glBufferData(GL_ARRAY_BUFFER, verticesSize3, verticesTab3, GL_STATIC_DRAW);
-	glBindVertexArray(*VAO);
-
-	//glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-	//glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+// statistics of the mesh builder to the console
+void printMeshStats(const char * name, const MeshStats & stats) {
+	std::cout << "Mesh " << name << ": " << stats.inputVertices << " -> " << stats.uniqueVertices << " vertices, ACMR "
+			  << stats.acmrInput << " (triangle list) / " << stats.acmrWelded << " (indexed) / "
+			  << stats.acmrOptimized << " (optimized)" << std::endl;
 }
 
+void printWinding(const char * name, const WindingReport & report, bool fixed) {
+	std::cout << "Winding of " << name << ": " << report.triangles << " triangles, " << report.wrong << " wrong"
+			  << (fixed && report.wrong > 0 ? " (fixed)" : "") << ", " << report.undecided << " undecided" << std::endl;
+}
 
-/*
-	VAO - vertex array object creation
-*/
-void configureAnotherVAO(unsigned int * VAO, const void * verticesTab, size_t verticesSize) {
-	// always add '*' before each parameter
-	glGenVertexArrays(1, *&VAO);  // xd
-	glBindVertexArray(*VAO);
-	glBufferData(GL_ARRAY_BUFFER, verticesSize, verticesTab, GL_STATIC_DRAW);
+// triangle list of 8-float vertices -> indexed mesh, triangles turned counter-clockwise toward the reference side
+void buildMesh(const char * name, const float * vertices, size_t verticesSize, const std::vector<unsigned int> & groupTriangles,
+			   Winding_Reference winding, IndexedMesh * mesh) {
+	MeshStats stats;
+	buildIndexedMesh(vertices, verticesSize / (8 * sizeof(float)), 8, groupTriangles, mesh, &stats);
+	printMeshStats(name, stats);
+	printWinding(name, fixWinding(mesh, winding), true);
 }
 
+// grid of building heights, source of all roof data
+HeightMap heightMap;
+
+// boxes of buildings for culling, indices of the ones drawn in this frame
+BuildingTable buildings;
+CityQuadtree cityQuadtree;		// districts over the table, rejects whole blocks at once
+std::vector<unsigned int> visibleBuildings;
+bool frustumCulling = true;		// 'C' key
+HorizonCulling horizonCulling;		// buildings under the skyline of nearer ones
+bool horizonCullingOn = true;		// 'H' key
+OcclusionCulling occlusionCulling;	// CPU depth buffer of the nearest buildings
+bool softwareOcclusion = true;		// 'O' key, 'P' writes the buffer to occlusion.pgm (temporary directory)
+OcclusionQueries occlusionQueries;	// GPU queries on boxes of city blocks (quadtree leaves)
+bool hardwareOcclusion = false;		// 'G' key
+std::vector<unsigned int> drawnBlocks;
+PotentiallyVisibleSet pvs;			// buildings seen from each street cell, built with --pvs
+bool usePvs = true;					// 'V' key
+CityLod cityLod;					// proxy boxes of far city blocks
+bool useLod = true;					// 'L' key
+GeometryArena proxyArena;			// proxy meshes of the blocks drawn far away lately
+std::vector<ArenaMesh> proxyMeshes;	// per quadtree node, indexCount 0 - not in the arena
+std::vector<unsigned int> proxyLastUse;	// frame the block was last drawn as its proxy
+std::vector<unsigned int> residentProxies;
+unsigned int frameNumber = 0;
+ImpostorAtlas impostorAtlas;		// pictures of building shapes for the far ring
+bool useImpostors = true;			// 'I' key
+std::vector<float> impostorInstances;
+BuildingPulling buildingPulling;	// 4 bytes per drawn building, boxes made by building_pulling.vs
+bool useVertexPulling = true;		// 'B' key
+IndirectDraws indirectDraws;		// floors of buildings and ground tiles as multi-draw indirect commands
+bool useIndirect = false;			// 'M' key, on when the context has multi-draw indirect
+GpuCulling gpuCulling;				// all buildings culled by a compute shader and drawn by vertex pulling
+bool useGpuCulling = false;			// 'U' key, with --gpu-culling on from the start
+bool useDepthPyramid = true;		// 'Z' key, GPU culling also against the depth of the last frame
+DrawOrder drawOrder;				// visible buildings nearest first
+bool frontToBack = true;			// 'F' key
+bool depthPrepass = false;			// 'E' key, depth of the pulled buildings first, then shading with GL_LEQUAL
+PipelineStatistics pipelineStatistics;	// shader invocations and GPU time of the frame
+bool faceBuckets = true;			// 'N' key, only faces turned to the camera are drawn (by direction)
+bool backFaceCulling = true;		// 'K' key, GL_CULL_FACE of clockwise (back) triangles
+
+// materials of indirectDraws: ground textures, then textures of the floor levels (level * 3 + face pair)
+const int MATERIAL_CROSSING = 0;
+const int MATERIAL_STREET = 1;
+const int MATERIAL_STREET2 = 2;
+const int MATERIAL_FLOORS = 3;
+const int INDIRECT_MATERIALS = MATERIAL_FLOORS + BuildingPulling::LEVELS * 3;
 
 /*
-	clear and delete VAO VBO EBO
+GROUND TILES
+	tiles of one texture inside the frustum as indirect draws of the ground mesh,
+	the quad is turned flat, so it lies half a unit under its position
 */
-void cleanVAO_VBO_EBO(unsigned int * VAO, unsigned int * VBO, unsigned int * EBO) {
-	glDeleteVertexArrays(1, *&VAO);
-	glDeleteBuffers(1, *&VBO);
-	//glDeleteBuffers(1, &EBO);
+void addGroundTiles(const Frustum & frustum, const std::vector<glm::vec3> & positions, int material, GLsizei indexCount) {
+	const glm::vec3 extent(0.5f, 0.0f, 0.5f);
+	for (size_t i = 0; i < positions.size(); i++) {
+		glm::vec3 center = positions[i] - glm::vec3(0.0f, 0.5f, 0.0f);
+		if (isBoxVisible(frustum, center, extent))
+			indirectDraws.add(material, 0, (GLuint)indexCount, glm::vec4(positions[i], 1.0f));
+	}
 }
 
+// frames a proxy stays in the arena after the block was last drawn as it
+const unsigned int PROXY_KEEP_FRAMES = 600;
 
 /*
-set how OpenGL should interpret objectCoords.cpp data
+PROXY STREAMING
+	a block gets its proxy mesh in proxyArena the first time it is drawn as the proxy (cut out of the proxies
+	of the whole city), a proxy not drawn for PROXY_KEEP_FRAMES gives its ranges back to the arena
+	false - the arena is full, the block stays at full detail this frame
 */
-void howInterpretVertexData(GLuint sizeOfRow, GLuint vertexCoordsNumber,
-							GLuint normalCoordsNumber, GLuint textureCoordsNumber) {
-	// position attribute:
-	// 0 - attribute location, 3 - number of vertex coords, 5* - size of row
-	//glVertexAttribPointer(0, vertexCoordsNumber, GL_FLOAT, GL_FALSE, sizeOfRow * sizeof(float), (void*)0);
-	glVertexAttribPointer(0, vertexCoordsNumber, GL_FLOAT, GL_FALSE, sizeOfRow * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
-
-	// normal attribute
-	// 1 - attribute location, 3 - number of vertex coords, 8* - size of row
-	//glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-	//glEnableVertexAttribArray(1);
-
-	// texture coord attribute
-	// 1 - attribute location, 2 - number of vertex coords, 5* - size of row, 3* - offset
-	//glVertexAttribPointer(1, textureCoordsNumber, GL_FLOAT, GL_FALSE, sizeOfRow * sizeof(float), (void*)(3 * sizeof(float)));
-	glVertexAttribPointer(1, textureCoordsNumber, GL_FLOAT, GL_FALSE, sizeOfRow * sizeof(float), (void*)(3 * sizeof(float)));
-	glEnableVertexAttribArray(1);
+bool prepareProxy(unsigned int block) {
+	proxyLastUse[block] = frameNumber;
+	if (proxyMeshes[block].indexCount != 0)
+		return true;
+	IndexedMesh part;
+	PackedMesh packed;
+	extractSubMesh(cityLod.getMesh(), cityLod.firstIndex(block), cityLod.indexCount(block), &part);
+	packMesh(part, proxyArena.getFormat(), &packed);
+	if (!proxyArena.add(packed, &proxyMeshes[block]))
+		return false;
+	residentProxies.push_back(block);
+	return true;
 }
 
+void dropUnusedProxies() {
+	for (size_t i = 0; i < residentProxies.size(); ) {
+		unsigned int block = residentProxies[i];
+		if (frameNumber - proxyLastUse[block] <= PROXY_KEEP_FRAMES) {
+			i++;
+			continue;
+		}
+		proxyArena.remove(&proxyMeshes[block]);
+		residentProxies[i] = residentProxies.back();
+		residentProxies.pop_back();
+	}
+}
+
+// how far from the roof (up or down) the character still stands on it
+const float COLLISION_TOLERANCE = 0.25f;
 
 
 /*
-set how OpenGL should interpret objectCoords.cpp data
+COLLISIONS
+	look up the cell under the character in the height map (constant time)
+	and decide if the character is over, on or inside the building
 */
-void howInterpretVertexData(GLuint sizeOfRow, GLuint vertexCoordsNumber,
-	GLuint normalCoordsNumber, GLuint textureCoordsNumber,
-	GLuint vertexOffset, GLuint normalOffset, GLuint textureOffset) {
-	// position attribute:
-	// 0 - attribute location, 3 - number of vertex coords, 5* - size of row
-	//glVertexAttribPointer(0, vertexCoordsNumber, GL_FLOAT, GL_FALSE, sizeOfRow * sizeof(float), (void*)0);
-	glVertexAttribPointer(0, vertexCoordsNumber, GL_FLOAT, GL_FALSE, sizeOfRow * sizeof(float), (void*)vertexOffset);
-	glEnableVertexAttribArray(0);
-
-	// normal attribute
-	// 1 - attribute location, 3 - number of vertex coords, 8* - size of row
-	glVertexAttribPointer(1, normalCoordsNumber, GL_FLOAT, GL_FALSE, sizeOfRow * sizeof(float), (void*)(normalOffset * sizeof(float)));
-	glEnableVertexAttribArray(1);
-
-	// texture coord attribute
-	// 1 - attribute location, 2 - number of vertex coords, 5* - size of row, 3* - offset
-	//glVertexAttribPointer(1, textureCoordsNumber, GL_FLOAT, GL_FALSE, sizeOfRow * sizeof(float), (void*)(3 * sizeof(float)));
-	glVertexAttribPointer(2, textureCoordsNumber, GL_FLOAT, GL_FALSE, sizeOfRow * sizeof(float), (void*)(textureOffset * sizeof(float)));
-	glEnableVertexAttribArray(2);
-}
-
-std::vector <glm::vec4> roofsPositions; 
-
-void GetRoofsPositions(std::vector <glm::vec4> cubePositions) 
+void checkColisions()
 {
-	std::vector <glm::vec4> temp; 
-	for (unsigned int i = 0; i < cubePositions.size(); i++)//copy all cubes positions and adds 1 to height
+	glm::vec3 pos = camera.Position;
+	float tolerance = COLLISION_TOLERANCE;
+
+	CellQuery block = heightMap.query(pos);
+	if (!block.occupied)
 	{
-		temp.push_back(glm::vec4(cubePositions[i].x-0.5, cubePositions[i].y+1, cubePositions[i].z-0.5, cubePositions[i].w));
+		camera.isOnTheRoof = false;
+		camera.nearestRoofYPosition = 0;
+		return;
 	}
 
-	for (unsigned int i = 0; i < temp.size(); i++)
+	float blockHeight = block.roofHeight;
+	if (pos.y > blockHeight + tolerance) //character is over te block
 	{
-		for (unsigned int j = 0; j < temp.size(); j++)
-		{
-			if (temp[i].x == temp[j].x && temp[i].z == temp[j].z && (temp[i].y > temp[j].y))
-			{
-				temp[j].x = -1;
-			}
-		}
+		camera.isOnTheRoof = false;
+		camera.nearestRoofYPosition = blockHeight;
 	}
-
-	for (unsigned int i = 0; i < temp.size(); i++)
+	else if (pos.y > blockHeight - tolerance)//character is on the roof
+	{
+		camera.isOnTheRoof = true;
+		camera.jumpHeight = 0;
+	}
+	else //character is inside a block - restart the game
 	{
-		if(temp[i].x > -1)
-			roofsPositions.push_back(temp[i]);
+		camera.SetUpCharacterMovementParameters();
 	}
 }
 
 
-void checkColisions()
+/*
+SWEPT COLLISIONS
+	checkColisions tests only the end of the move, so a fast character can pass through a corner
+	walk the cells between old and new position and stop at the first building:
+		entered from above - land on the roof
+		entered from the side - crashed into the wall, restart the game
+	segment is lifted by the tolerance, so standing on the roof doesn't count as being inside
+*/
+void checkSweptCollisions(const glm::vec3 & previousPosition)
 {
-	float blockSize = 1;
-	glm::vec3 pos = camera.Position;
-	//moving compared piont forward
-	float alpha = atan(camera.Front.z / camera.Front.x);
-	float x = cos(alpha)*camera.cameraDistance;
-	float z = sin(alpha)*camera.cameraDistance;
-	//pos.x += x;
-	//pos.z += z;
-
-
+	glm::vec3 lift(0.0f, COLLISION_TOLERANCE, 0.0f);
+	SweepHit hit;
+	if (!heightMap.sweep(previousPosition + lift, camera.Position + lift, &hit))
+		return;
 
-	float tolerance = 0.25;
-
-	for (unsigned int i = 0; i < roofsPositions.size(); i++)		
+	if (hit.normal.y > 0.0f)
 	{
-		glm::vec4 block = roofsPositions[i];
-		float blockHeight=roofsPositions[i].y;
-		bool isOnTheRoof = false;
-	//	blockHeight += camera.characterHeight;
-		//if character is inside a block
-   		if (((block.x + blockSize) > pos.x) && (block.x < pos.x) && ((block.z + blockSize) > pos.z) && (block.z < pos.z))
-		{
-			if (pos.y > blockHeight + tolerance) //character is over te block
-			{
-				camera.isOnTheRoof = false;
-				camera.nearestRoofYPosition = blockHeight;
-				break;
-			}
-			else if (pos.y > blockHeight - tolerance)//character is on the roof
-			{
-				camera.isOnTheRoof = isOnTheRoof = true;
-				camera.jumpHeight = 0;
-				break;
-			}
-			else //character is inside a block - restart the game
-			{
-				camera.SetUpCharacterMovementParameters();
-				break;
-			}
-		}
-		if (!isOnTheRoof)
-		{
-			camera.isOnTheRoof = false;
-			camera.nearestRoofYPosition = 0;
-		}
-
-
+		camera.Position = hit.position - lift;
+		camera.Position.y = (float)heightMap.topHeight(hit.cell.x, hit.cell.z);
+		camera.isOnTheRoof = true;
+		camera.jumpHeight = 0;
+	}
+	else
+	{
+		camera.SetUpCharacterMovementParameters();
 	}
 }
 
@@ -441,7 +557,11 @@ _________________________________________________________
 _________________________________________________________
 _________________________________________________________
 */
-int main() {
+int main(int argc, char * argv[]) {
+
+	Options options = parseOptions(argc, argv);
+	if (options.bench != NULL)
+		return runBenchmark(options.bench, options.seed) ? 0 : 1;
 
 	// init GLFW lib
 	initGLFW();
@@ -458,57 +578,142 @@ int main() {
 
 	// init GLAD lib
 	initGLAD();
+	useIndirect = loadMultiDrawIndirect((GLADloadproc)glfwGetProcAddress);
+	std::cout << "OpenGL " << glGetString(GL_VERSION) << ", multi-draw indirect " << (useIndirect ? "on" : "not available") << std::endl;
+
+	// ring of per-frame data, persistently mapped when the context has buffer storage
+	loadBufferStorage((GLADloadproc)glfwGetProcAddress);
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformAlignment);
+	frameData.create(FRAME_DATA_BYTES);
+	std::cout << "Frame data: " << (frameData.isPersistent() ? "persistently mapped" : "glBufferSubData") << " ring of "
+			  << RingBuffer::FRAMES << " x " << FRAME_DATA_BYTES / 1024 << " KB" << std::endl;
+	pipelineStatistics.create();
+	std::cout << "Shader invocations " << (pipelineStatistics.hasCounters() ? "counted" : "not available") << std::endl;
 
 	// enable z-buffer
 	glEnable(GL_DEPTH_TEST); 
+	// every mesh is counter-clockwise from outside (from inside for the sky), see buildMesh
+	glFrontFace(GL_CCW);
+	glCullFace(GL_BACK);
+	glEnable(GL_CULL_FACE);
 
 	// create shader object
 	Shader ourShader("vertexshader.vs", "fragmentshader.fs"); 
 	Shader lampShader("lamp.vs", "lamp.fs");
 	Shader lightingShader("lighting_maps.vs", "lighting_maps.fs");
+	glUniformBlockBinding(lightingShader.ID, glGetUniformBlockIndex(lightingShader.ID, "Draw"), DRAW_BLOCK);
 	Shader skyboxShader("skybox.vs", "skybox.fs");
+	Shader impostorShader("impostor.vs", "impostor.fs");
+	Shader pullingShader("building_pulling.vs", "lighting_maps.fs");
+	Shader depthShader("building_pulling.vs", "depth_only.fs");
+	Shader indirectShader("lighting_indirect.vs", "lighting_maps.fs");
 
 	// vectors for models
-	srand(time(NULL));
 	std::vector <glm::vec4> cubePositions;  // !!!
 	std::vector <glm::vec3> crossingPositions;
 	std::vector <glm::vec3> streetPositions;
 	std::vector <glm::vec3> street2Positions;
 
+	// map City from the snapshot (it has to live as long as its meshes are used)
+	CitySnapshot snapshot;
+	if (options.loadCity != NULL) {
+		if (!snapshot.open(options.loadCity)) {
+			glfwTerminate();
+			return -1;
+		}
+		options.seed = snapshot.seed();
+		options.sizeOfCity = snapshot.sizeOfCity();
+		snapshot.copySection(SECTION_CUBES, &cubePositions);
+		snapshot.copySection(SECTION_CROSSINGS, &crossingPositions);
+		snapshot.copySection(SECTION_STREETS, &streetPositions);
+		snapshot.copySection(SECTION_STREETS2, &street2Positions);
+
+		size_t count;
+		const HeightCell * cells = (const HeightCell *)snapshot.section(SECTION_HEIGHT_MAP, &count);
+		if (cells == NULL || count != (size_t)options.sizeOfCity * options.sizeOfCity) {
+			std::cout << "Snapshot has no height map of the city: " << options.loadCity << std::endl;
+			glfwTerminate();
+			return -1;
+		}
+		heightMap.assign(options.sizeOfCity, options.sizeOfCity, cells);
+
+		if (const void * mesh = snapshot.section(SECTION_BUILDING_MESH, &count)) {
+			buildingMesh = (const float *)mesh;
+			buildingMeshSize = count * sizeof(float);
+		}
+		if (const void * mesh = snapshot.section(SECTION_GROUND_MESH, &count)) {
+			groundMesh = (const float *)mesh;
+			groundMeshSize = count * sizeof(float);
+		}
+	}
+
 	// set size and generate City
-	int sizeOfCity = camera.sizeOfCity;
-	generateCity(&cubePositions, sizeOfCity);
-	generateCrossings(&crossingPositions, sizeOfCity);
-	generateStreet(&streetPositions, sizeOfCity);
-	generateStreet2(&street2Positions, sizeOfCity);
-
-	GetRoofsPositions(cubePositions);
-
-	// building-cube VAO, main VBO, EBO for indices (not used)
-	unsigned int VBO, VAO, VAO2, VAO3, VAO4, EBO;
-	configureVAO_VBO_EBO(&VAO, &VBO, &EBO);
-	howInterpretVertexData(8, 3, 3, 2, 0, 3, 6);
-
-	// crossing, streets
-	configureAnotherVAO(&VAO2, verticesTab2, verticesSize2);
-	howInterpretVertexData(8, 3, 3, 2, 0, 3, 6);
-	configureAnotherVAO(&VAO3, verticesTab2, verticesSize2);
-	howInterpretVertexData(8, 3, 3, 2, 0, 3, 6);
-	configureAnotherVAO(&VAO4, verticesTab2, verticesSize2);
-	howInterpretVertexData(8, 3, 3, 2, 0, 3, 6);
-
-	// light cube VAO
-	unsigned int lightVAO;
-	glGenVertexArrays(1, &lightVAO);
-	glBindVertexArray(lightVAO);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
-	
-	// skybox VAO
-	unsigned int skyboxVAO, skyboxVBO;
-	configureAnotherVAO(&skyboxVAO, skyboxVertices, skyboxVerticesSize);
-	howInterpretVertexData(8, 3, 3, 2, 0, 3, 6);
+	int sizeOfCity = options.sizeOfCity;
+	camera.sizeOfCity = sizeOfCity;
+	camera.SetUpCharacterMovementParameters();
+	if (!snapshot.isOpen()) {
+		srand(options.seed);
+		generateCity(&cubePositions, &heightMap, sizeOfCity);
+		generateCrossings(&crossingPositions, sizeOfCity);
+		generateStreet(&streetPositions, sizeOfCity);
+		generateStreet2(&street2Positions, sizeOfCity);
+	}
+
+	buildings.build(cubePositions);
+	cityQuadtree.build(&buildings);
+	occlusionQueries.resize(cityQuadtree.getNodes().size());
+	cityLod.build(buildings, cityQuadtree, cubePositions);
+	if (options.pvs) {
+		// far corners of the projection at the widest zoom (the far plane is a plane, not a sphere)
+		pvs.build(heightMap, buildings, cityQuadtree, farCornerDistance(glm::radians(ZOOM), (float)SCR_WIDTH / (float)SCR_HEIGHT, 100.0f));
+		std::cout << "PVS: " << pvs.streetCells() << " street cells in " << pvs.buildMilliseconds() << " ms, "
+				  << pvs.averageVisible() << " buildings per cell, " << pvs.memoryBytes() / 1024 << " KB (bitsets "
+				  << pvs.uncompressedBytes() / 1024 << " KB)" << std::endl;
+	}
+
+	// write City, so the same one can be loaded again
+	if (options.saveCity != NULL) {
+		CityData city = { (uint32_t)sizeOfCity, options.seed, &cubePositions, &crossingPositions,
+						  &streetPositions, &street2Positions, &heightMap,
+						  buildingMesh, buildingMeshSize, groundMesh, groundMeshSize };
+		CitySnapshot::write(options.saveCity, city);
+	}
+
+	// indexed meshes for every draw, faces of the cube keep their place (each has its own texture)
+	IndexedMesh cubeMesh, quadMesh, skyMesh;
+	buildMesh("building", buildingMesh, buildingMeshSize, std::vector<unsigned int>(buildingMeshSize / (8 * sizeof(float)) / 6, 2),
+			  WINDING_NORMALS, &cubeMesh);
+	buildMesh("ground", groundMesh, groundMeshSize, std::vector<unsigned int>(), WINDING_NORMALS, &quadMesh);
+	buildMesh("sky", skyboxVertices, skyboxVerticesSize, std::vector<unsigned int>(), WINDING_INWARD, &skyMesh);
+	printMeshStats("proxies", cityLod.getMeshStats());
+	printWinding("proxies", checkWinding(cityLod.getMesh(), WINDING_NORMALS), false);
+
+	// buildings, the lamp and boxes of city blocks for occlusion queries share the cube
+	MeshBuffers cube = uploadMesh("building", cubeMesh, options.vertexFormat);
+	MeshBuffers ground = uploadMesh("ground", quadMesh, options.vertexFormat);
+	MeshBuffers sky = uploadMesh("sky", skyMesh, options.vertexFormat, true);
+
+	// proxies of far city blocks (world space, too big for snorm) come and go in one arena, sized for the proxies
+	// of the whole city and 1/8 more, so a block doesn't miss its place because the free space is in pieces
+	const IndexedMesh & proxyMesh = cityLod.getMesh();
+	uint32_t proxyVertices = (uint32_t)(proxyMesh.vertices.size() / proxyMesh.floatsPerVertex);
+	uint32_t proxyIndices = (uint32_t)proxyMesh.indices.size();
+	proxyArena.create(VERTEX_FLOAT, proxyVertices + proxyVertices / 8, proxyIndices + proxyIndices / 8);
+	proxyMeshes.assign(cityQuadtree.getNodes().size(), ArenaMesh());
+	proxyLastUse.assign(cityQuadtree.getNodes().size(), 0);
+	std::cout << "Proxy arena: " << proxyArena.memoryBytes() / 1024 << " KB for " << proxyVertices
+			  << " vertices and " << proxyIndices << " indices" << std::endl;
+
+	// impostor quad (triangle strip of corners) and instances of far buildings, refilled every frame
+	const float impostorQuad[8] = { -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f };
+	// (instances are read from the frame's range of the ring buffer)
+	unsigned int impostorVAO, impostorQuadVBO;
+	glGenVertexArrays(1, &impostorVAO);
+	glGenBuffers(1, &impostorQuadVBO);
+	glBindVertexArray(impostorVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, impostorQuadVBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(impostorQuad), impostorQuad, GL_STATIC_DRAW);
+	ImpostorCorner::setup();
 
 	// load texture
 	unsigned int textureCrossing, textureStreet, textureStreet2;
@@ -537,6 +742,56 @@ int main() {
 	textureWall4_fb = loadTexture("textures/level4/wall1_1.jpg");
 	textureWall4_rl = loadTexture("textures/level4/wall1_2.jpg");
 	textureWall4_tb = loadTexture("textures/level4/concrete4.jpg");
+	// textures of the levels in the order of the texture number of cubePositions (front + back, left + right, bottom + top)
+	const unsigned int levelTextures[4][3] = { { textureWall3_fb, textureWall3_rl, textureWall3_tb },
+											   { textureWall4_fb, textureWall4_rl, textureWall4_tb },
+											   { textureWall1_fb, textureWall1_rl, textureWall1_tb },
+											   { textureWall2_fb, textureWall2_rl, textureWall2_tb } };
+	// average colors of the levels for proxies
+	unsigned int lodAtlas = bakeLodAtlas(levelTextures);
+
+	// every building shape seen from all around for impostors, lit as if it stood in the middle of the city
+	impostorAtlas.collect(buildings, cubePositions);
+	{
+		glBindVertexArray(cube.VAO);
+		frameData.beginFrame();
+		const glm::vec3 cityCenter(sizeOfCity * 0.5f, 0.0f, sizeOfCity * 0.5f);
+		impostorAtlas.capture([&](const ImpostorArchetype & archetype, const glm::vec3 & eye,
+								  const glm::mat4 & captureView, const glm::mat4 & captureProjection) {
+			setLighting(lightingShader, lightPos - cityCenter, eye);
+			lightingShader.setMat4("view", captureView);
+			lightingShader.setMat4("projection", captureProjection);
+			for (int floor = 0; floor < archetype.height; floor++)
+				drawCube(glm::vec3(0.0f, (float)floor, 0.0f), levelTextures[archetype.level]);
+		});
+		frameData.endFrame();
+
+		std::cout << "Impostors: " << impostorAtlas.getArchetypes().size() << " building shapes captured in "
+				  << impostorAtlas.captureMilliseconds() << " ms, atlas " << impostorAtlas.memoryBytes() / 1024 << " KB" << std::endl;
+	}
+	// per-draw records of the indirect draws on the cube and ground meshes, refilled every frame
+	if (useIndirect) {
+		indirectDraws.create();
+		indirectDraws.attach(cube.VAO);
+		indirectDraws.attach(ground.VAO);
+	}
+
+	// records of buildings drawn by vertex pulling, refilled every frame
+	buildingPulling.create();
+	if (!BuildingPulling::canPull(sizeOfCity)) {
+		std::cout << "City is too big for vertex pulling records, buildings are drawn by floors" << std::endl;
+		useVertexPulling = false;
+	}
+	// records of all buildings stay on the GPU for the compute culling
+	if (loadComputeCulling((GLADloadproc)glfwGetProcAddress) && BuildingPulling::canPull(sizeOfCity)) {
+		if (gpuCulling.create(buildings, cubePositions))
+			useGpuCulling = options.gpuCulling;
+		else
+			gpuCulling.release();
+	}
+	if (options.gpuCulling && !useGpuCulling)
+		std::cout << "GPU culling needs GL 4.3 compute shaders, buildings are culled on the CPU" << std::endl;
+
 	// diffuse and specular maps for lighting shader
 	unsigned int diffuseMap = loadTexture("textures/wood.png");
 	unsigned int specularMap = loadTexture("textures/woodspec.png");
@@ -555,6 +810,17 @@ int main() {
 	lightingShader.use();
 	lightingShader.setInt("material.diffuse", 0);
 	lightingShader.setInt("material.specular", 1);
+	// buildings drawn by vertex pulling are shaded by the same lighting_maps.fs
+	pullingShader.use();
+	pullingShader.setInt("material.diffuse", 0);
+	pullingShader.setInt("material.specular", 1);
+	pullingShader.setInt("buildings", BUILDINGS_UNIT);
+	depthShader.use();
+	depthShader.setInt("buildings", BUILDINGS_UNIT);
+	// multi-draw indirect floors and ground tiles too
+	indirectShader.use();
+	indirectShader.setInt("material.diffuse", 0);
+	indirectShader.setInt("material.specular", 1);
 
 	// skybox shader configuration - join group of textures
 	unsigned int cubemapTexture = loadCubemap(faces);
@@ -566,248 +832,436 @@ int main() {
 RENDER LOOP
 	(if window shouldn't be closed do):
 */
+	glm::vec3 previousPosition = camera.Position;	// position before the last simulation step
+	// loading bound textures and VAOs behind the state cache
+	glState.invalidate();
+	lastFrame = glfwGetTime();
 	while (!glfwWindowShouldClose(window))
 	{
-		// per-frame time logic
-		float currentFrame = glfwGetTime();
-		deltaTime = currentFrame - lastFrame;
+		// per-frame time logic (double, float loses precision after a few hours)
+		double currentFrame = glfwGetTime();
+		double frameTime = currentFrame - lastFrame;
+		if (frameTime > MAX_FRAME_TIME)
+			frameTime = MAX_FRAME_TIME;
 		lastFrame = currentFrame;
+		accumulator += frameTime;
+
+		// SIMULATION - as many fixed steps as fit into the elapsed time
+		{
+			ScopedTimer timer(frameStats, "simulation");
+			int steps = 0;
+			while (accumulator >= SIMULATION_STEP) {
+				previousPosition = camera.Position;
 
-		// process input from mouse and keyboard
-		processInput(window);
+				// process input from mouse and keyboard
+				processInput(window);
 
-		//configureCharacterMovement
-		checkColisions();
-		camera.moveCharater(deltaTime);
+				//configureCharacterMovement
+				checkColisions();
+				camera.moveCharater(deltaTime);
+				checkSweptCollisions(previousPosition);
 
+				accumulator -= SIMULATION_STEP;
+				steps++;
+			}
+			frameStats.addCount("steps", steps);
+		}
+
+		// camera is drawn between the last two steps, by the part of the step that has already passed
+		float alpha = (float)(accumulator / SIMULATION_STEP);
+		glm::vec3 renderPosition = glm::mix(previousPosition, camera.Position, alpha);
+		double renderStart = glfwGetTime();
+
+
+		// region of the ring for this frame (waits if the GPU still reads it)
+		frameData.beginFrame();
 
 		// render background and clear buffers
 		glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); 
+		pipelineStatistics.begin();
 
 		// activate lightingShader
-		lightingShader.use();
-		lightingShader.setVec3("light.position", lightPos);
-		lightingShader.setVec3("viewPos", camera.Position);
-		// light properties
-		lightingShader.setVec3("light.ambient", 0.2f, 0.2f, 0.2f);
-		lightingShader.setVec3("light.diffuse", 1.0f, 1.0f, 1.0f);
-		lightingShader.setVec3("light.specular", 1.0f, 1.0f, 1.0f);
-		// material properties
-		lightingShader.setVec3("material.specular", 0.5f, 0.5f, 0.5f);
-		lightingShader.setFloat("material.shininess", 32.0f);
+		setLighting(lightingShader, lightPos, renderPosition);
 
 		// projection matrix (changes every frame)
 		glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
 		lightingShader.setMat4("projection", projection);
 		// camera/view transformation
-		glm::mat4 view = camera.GetViewMatrix();	
+		glm::mat4 view = camera.GetViewMatrix(renderPosition);
 		lightingShader.setMat4("view", view);
 
 
 		// BUILDINGS - 1st group of object
-		configureVAO_VBO_EBO(&VAO, &VBO, &EBO);
-		howInterpretVertexData(8, 3, 3, 2, 0, 3, 6);
+		glState.bindVertexArray(cube.VAO);
+
+		// visible buildings (frustum culling of the quadtree, then of buildings in crossed leaves),
+		// with GPU culling none, the compute shader writes the buildings drawn after the blocks
+		glm::mat4 viewProjection = projection * view;
+		visibleBuildings.clear();
+		if (useGpuCulling) {
+			ScopedTimer timer(frameStats, "culling");
+			gpuCulling.cull(viewProjection, useDepthPyramid);
+			lightingShader.use();
+		}
+		else {
+			ScopedTimer timer(frameStats, "culling");
+			Frustum frustum = extractFrustum(viewProjection);
+			if (usePvs && pvs.visibleFrom(renderPosition, &visibleBuildings)) {
+				// set of the street cell under the camera, then the frustum
+				frameStats.addCount("pvs", (double)visibleBuildings.size());
+				size_t kept = 0;
+				for (size_t b = 0; b < visibleBuildings.size(); b++) {
+					unsigned int building = visibleBuildings[b];
+					if (!frustumCulling || isBoxVisible(frustum, buildings.center(building), buildings.extent(building)))
+						visibleBuildings[kept++] = building;
+				}
+				visibleBuildings.resize(kept);
+			}
+			else if (frustumCulling)
+				cityQuadtree.cullFrustum(frustum, buildings, &visibleBuildings);
+			else
+				for (unsigned int b = 0; b < buildings.count; b++)
+					visibleBuildings.push_back(b);
+		}
+		if (horizonCullingOn && !useGpuCulling) {
+			ScopedTimer timer(frameStats, "horizon");
+			horizonCulling.cull(renderPosition, buildings, &visibleBuildings);
+			frameStats.addCount("under horizon", (double)horizonCulling.culled());
+		}
+		if (softwareOcclusion && !useGpuCulling) {
+			ScopedTimer timer(frameStats, "occlusion");
+			occlusionCulling.cull(viewProjection, renderPosition, buildings, &visibleBuildings);
+			frameStats.addCount("occluded", (double)occlusionCulling.culled());
+		}
+		frameStats.addCount("visible", (double)visibleBuildings.size());
+		frameStats.addCount("buildings", (double)buildings.count);
+		bool sortedOrder = frontToBack && !useGpuCulling;
+		size_t nextSlice = 1;	// slice 0 is the group made by buildingPulling.clear
+		if (sortedOrder) {
+			ScopedTimer timer(frameStats, "sorting");
+			drawOrder.sortFrontToBack(renderPosition, buildings, cityQuadtree, &visibleBuildings);
+		}
 
-		for (unsigned int i = 0; i < cubePositions.size(); i++)		{
-			// calculate the model matrix for each object and pass it to shader before drawing
-			// level 4
-			if (cubePositions[i].w == 1.0f) {
-				glm::mat4 model;
-				model = glm::translate(model, glm::vec3(cubePositions[i].x, cubePositions[i].y, cubePositions[i].z));
-				model = glm::rotate(model, glm::radians(0.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-				lightingShader.setMat4("model", model);
-
-				// back
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, textureWall4_fb);
-				glBindVertexArray(VAO);
-				glDrawArrays(GL_TRIANGLES, 0, 6);
-
-				// front
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, textureWall4_fb);
-				glDrawArrays(GL_TRIANGLES, 6, 6);
-
-				// left
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, textureWall4_rl);
-				glDrawArrays(GL_TRIANGLES, 12, 6);
-
-				// right
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, textureWall4_rl);
-				glDrawArrays(GL_TRIANGLES, 18, 6);
-
-				// bottom
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, textureWall4_tb);
-				glDrawArrays(GL_TRIANGLES, 24, 6);
-
-				// top
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, textureWall4_tb);
-				glDrawArrays(GL_TRIANGLES, 30, 6);
+		// buildings of one city block follow each other (quadtree order), each block is one conditional draw,
+		// a block small on screen is drawn at once as its proxy instead
+		if (hardwareOcclusion)
+			occlusionQueries.beginFrame();
+		drawnBlocks.clear();
+		cityLod.setProjection(glm::radians(camera.Zoom), (float)SCR_HEIGHT);
+		cityLod.resetStats();
+		unsigned int triangles = 0;
+		bool blockProxy = false, blockImpostors = false;
+		impostorInstances.clear();
+		buildingPulling.clear();
+		if (useIndirect)
+			indirectDraws.clear(INDIRECT_MATERIALS);
+		for (unsigned int b = 0; b < visibleBuildings.size(); b++) {
+			unsigned int building = visibleBuildings[b];
+			unsigned int block = cityQuadtree.leafOf(building);
+			if (drawnBlocks.empty() || drawnBlocks.back() != block) {
+				if (hardwareOcclusion && !drawnBlocks.empty())
+					occlusionQueries.endBlock();
+				drawnBlocks.push_back(block);
+				if (hardwareOcclusion)
+					occlusionQueries.beginBlock(block);
+				// pulled buildings are drawn after the blocks, each block on its own under its condition,
+				// else a group per distance slice keeps the draws front-to-back across texture levels
+				if (hardwareOcclusion && useVertexPulling)
+					buildingPulling.beginGroup(block);
+				else if (sortedOrder && useVertexPulling && nextSlice < drawOrder.getSliceStarts().size() &&
+						 b >= drawOrder.getSliceStarts()[nextSlice])
+					buildingPulling.beginGroup(nextSlice++);
+
+				blockImpostors = useImpostors && cityLod.screenSize(block, renderPosition) < IMPOSTOR_PIXELS;
+				blockProxy = !blockImpostors && useLod && cityLod.useProxy(block, renderPosition) && prepareProxy(block);
+				if (blockProxy) {
+					setModel(glm::mat4());
+					glState.bindTexture(GL_TEXTURE0, GL_TEXTURE_2D, lodAtlas);
+					glState.bindVertexArray(proxyArena.getVAO());
+					proxyArena.draw(proxyMeshes[block]);
+					glState.bindVertexArray(cube.VAO);
+					triangles += cityLod.proxyTriangles(block);
+				}
+			}
+			if (blockImpostors)
+				impostorAtlas.addInstance(building, buildings, &impostorInstances);
+			if (blockProxy || blockImpostors)
+				continue;
+			// every face of a box points along one axis, the ones turned away from the camera are skipped
+			// as whole direction buckets: the box of the building decides for pulled boxes, the floor for floors
+			if (useVertexPulling) {
+				unsigned int faces = faceBuckets ? facesTowardEye(renderPosition, buildings.center(building), buildings.extent(building)) : ALL_FACES;
+				buildingPulling.add(building, buildings, cubePositions, faces);
+				triangles += faceCount(faces) * 2;
+				continue;
 			}
 
-			// level 1
-			else if (cubePositions[i].w == 2.0f){
-				glm::mat4 model;
-				model = glm::translate(model, glm::vec3(cubePositions[i].x, cubePositions[i].y, cubePositions[i].z));
-				model = glm::rotate(model, glm::radians(0.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-				lightingShader.setMat4("model", model);
-
-				// back
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, textureWall1_fb);
-				glBindVertexArray(VAO);
-				glDrawArrays(GL_TRIANGLES, 0, 6);
-
-				// front
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, textureWall1_fb);
-				glDrawArrays(GL_TRIANGLES, 6, 6);
-
-				// left
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, textureWall1_rl);
-				glDrawArrays(GL_TRIANGLES, 12, 6);
-
-				// right
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, textureWall1_rl);
-				glDrawArrays(GL_TRIANGLES, 18, 6);
-
-				// bottom
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, textureWall1_tb);
-				glDrawArrays(GL_TRIANGLES, 24, 6);
-
-				// top
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, textureWall1_tb);
-				glDrawArrays(GL_TRIANGLES, 30, 6);
+			const glm::vec3 floorExtent(0.5f);
+			unsigned int lastCube = buildings.firstCube[building] + buildings.cubeCount[building];
+			// indirect draws are submitted after the blocks, with occlusion queries floors are drawn one by one
+			if (useIndirect && !hardwareOcclusion) {
+				for (unsigned int i = buildings.firstCube[building]; i < lastCube; i++) {
+					glm::vec4 instance(glm::vec3(cubePositions[i]), 0.0f);
+					int material = MATERIAL_FLOORS + (int)cubePositions[i].w * 3;
+					if (!faceBuckets) {
+						for (int pair = 0; pair < 3; pair++)
+							indirectDraws.add(material + pair, pair * 12, 12, instance);
+						triangles += CityLod::CUBE_TRIANGLES;
+						continue;
+					}
+					unsigned int faces = facesTowardEye(renderPosition, glm::vec3(cubePositions[i]), floorExtent);
+					for (int face = 0; face < FACE_COUNT; face++)
+						if (faces & (1u << face))
+							indirectDraws.add(material + face / 2, face * 6, 6, instance);
+					triangles += faceCount(faces) * 2;
+				}
+				continue;
+			}
+			for (unsigned int i = buildings.firstCube[building]; i < lastCube; i++) {
+				unsigned int faces = faceBuckets ? facesTowardEye(renderPosition, glm::vec3(cubePositions[i]), floorExtent) : ALL_FACES;
+				drawCube(glm::vec3(cubePositions[i]), levelTextures[(int)cubePositions[i].w], faces);
+				triangles += faceCount(faces) * 2;
 			}
+		}
+		if (hardwareOcclusion && !drawnBlocks.empty())
+			occlusionQueries.endBlock();
+
+		// PULLED BUILDINGS - full detail buildings of the frame, 3 instanced draws per texture level for whole boxes
+		// and one per non-empty direction bucket
+		// with occlusion queries the records are grouped by city block and every block is drawn
+		// under the conditional render of its own query, otherwise the frame is a single group
+		// the depth pre-pass draws all faces of a level at once without color, the shading pass
+		// then runs lighting_maps.fs only for the fragments that are really seen
+		if (useVertexPulling) {
+			buildingPulling.upload();
+			glState.bindTexture(GL_TEXTURE0 + BUILDINGS_UNIT, GL_TEXTURE_BUFFER, buildingPulling.getTexture());
+			if (depthPrepass) {
+				depthShader.use();
+				depthShader.setMat4("projection", projection);
+				depthShader.setMat4("view", view);
+				glState.bindVertexArray(buildingPulling.getVAO());
+				glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+				for (size_t group = 0; group < buildingPulling.groupCount(); group++) {
+					if (hardwareOcclusion)
+						occlusionQueries.beginBlock(buildingPulling.groupId(group));
+					for (int level = 0; level < BuildingPulling::LEVELS; level++)
+						for (int bucket = 0; bucket < BuildingPulling::BUCKETS; bucket++) {
+							GLsizei count = buildingPulling.buildingCount(group, level, bucket);
+							if (count == 0)
+								continue;
+							depthShader.setInt("firstBuilding", buildingPulling.firstBuilding(group, level, bucket));
+							if (bucket == BuildingPulling::WHOLE_BOXES)
+								glDrawArraysInstanced(GL_TRIANGLES, 0, 3 * BuildingPulling::FACE_VERTICES, count);
+							else
+								glDrawArraysInstanced(GL_TRIANGLES, bucket * BuildingPulling::SIDE_VERTICES, BuildingPulling::SIDE_VERTICES, count);
+						}
+					if (hardwareOcclusion)
+						occlusionQueries.endBlock();
+				}
+				glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+				glState.depthFunc(GL_LEQUAL);
+			}
+			setLighting(pullingShader, lightPos, renderPosition);
+			pullingShader.setMat4("projection", projection);
+			pullingShader.setMat4("view", view);
+			glState.activeTexture(GL_TEXTURE0);
+			glState.bindVertexArray(buildingPulling.getVAO());
+			for (size_t group = 0; group < buildingPulling.groupCount(); group++) {
+				if (hardwareOcclusion)
+					occlusionQueries.beginBlock(buildingPulling.groupId(group));
+				for (int level = 0; level < BuildingPulling::LEVELS; level++) {
+					GLsizei count = buildingPulling.buildingCount(group, level, BuildingPulling::WHOLE_BOXES);
+					if (count > 0) {
+						pullingShader.setInt("firstBuilding", buildingPulling.firstBuilding(group, level, BuildingPulling::WHOLE_BOXES));
+						for (int texture = 0; texture < 3; texture++) {
+							glState.bindTexture(GL_TEXTURE_2D, levelTextures[level][texture]);
+							glDrawArraysInstanced(GL_TRIANGLES, texture * BuildingPulling::FACE_VERTICES, BuildingPulling::FACE_VERTICES, count);
+						}
+					}
+					// direction buckets, one face each
+					for (int face = 0; face < FACE_COUNT; face++) {
+						count = buildingPulling.buildingCount(group, level, face);
+						if (count == 0)
+							continue;
+						pullingShader.setInt("firstBuilding", buildingPulling.firstBuilding(group, level, face));
+						glState.bindTexture(GL_TEXTURE_2D, levelTextures[level][face / 2]);
+						glDrawArraysInstanced(GL_TRIANGLES, face * BuildingPulling::SIDE_VERTICES, BuildingPulling::SIDE_VERTICES, count);
+					}
+				}
+				if (hardwareOcclusion)
+					occlusionQueries.endBlock();
+			}
+			glState.depthFunc(GL_LESS);
+			lightingShader.use();
+			frameStats.addCount("pulled bytes", (double)buildingPulling.uploadedBytes());
+			frameStats.addCount("pulled groups", (double)buildingPulling.groupCount());
+		}
 
-			// level 2
-			else if (cubePositions[i].w == 3.0f) {
+		// GPU CULLED BUILDINGS - the same 12 indirect draws for any city, instance counts written by the cull
+		if (useGpuCulling) {
+			glState.bindTexture(GL_TEXTURE0 + BUILDINGS_UNIT, GL_TEXTURE_BUFFER, gpuCulling.getTexture());
+			glState.bindVertexArray(gpuCulling.getVAO());
+			if (depthPrepass) {
+				depthShader.use();
+				depthShader.setMat4("projection", projection);
+				depthShader.setMat4("view", view);
+				glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+				for (int level = 0; level < GpuCulling::LEVELS; level++) {
+					depthShader.setInt("firstBuilding", gpuCulling.firstBuilding(level));
+					for (int texture = 0; texture < 3; texture++)
+						gpuCulling.draw(level, texture);
+				}
+				glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+				glState.depthFunc(GL_LEQUAL);
+			}
+			setLighting(pullingShader, lightPos, renderPosition);
+			pullingShader.setMat4("projection", projection);
+			pullingShader.setMat4("view", view);
+			glState.activeTexture(GL_TEXTURE0);
+			for (int level = 0; level < GpuCulling::LEVELS; level++) {
+				pullingShader.setInt("firstBuilding", gpuCulling.firstBuilding(level));
+				for (int texture = 0; texture < 3; texture++) {
+					glState.bindTexture(GL_TEXTURE_2D, levelTextures[level][texture]);
+					gpuCulling.draw(level, texture);
+				}
+			}
+			glState.depthFunc(GL_LESS);
+			lightingShader.use();
+			frameStats.addCount("gpu commands", gpuCulling.commandCount());
+			frameStats.addCount("gpu culling bytes", (double)gpuCulling.uploadedBytes());
+		}
+
+		// IMPOSTORS - buildings of the far ring, one instanced draw of quads
+		GLsizei impostorCount = (GLsizei)(impostorInstances.size() / ImpostorAtlas::INSTANCE_FLOATS);
+		if (impostorCount > 0) {
+			impostorShader.use();
+			impostorShader.setMat4("projection", projection);
+			impostorShader.setMat4("view", view);
+			impostorShader.setVec3("viewPos", renderPosition);
+			impostorShader.setFloat("frames", (float)ImpostorAtlas::FRAMES);
+			impostorShader.setFloat("tilesPerSide", (float)impostorAtlas.getTilesPerSide());
+			impostorShader.setInt("atlas", 0);
+			glState.bindTexture(GL_TEXTURE0, GL_TEXTURE_2D, impostorAtlas.getTexture());
+			GLintptr instances = frameData.write(impostorInstances.data(), impostorInstances.size() * sizeof(float), sizeof(float));
+			glState.bindVertexArray(impostorVAO);
+			glBindBuffer(GL_ARRAY_BUFFER, frameData.getBuffer());
+			ImpostorInstance::setup(1, (GLuint)instances);
+			glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, impostorCount);
+			lightingShader.use();
+			triangles += impostorCount * 2;
+		}
+		frameStats.addCount("impostors", impostorCount);
+		frameStats.addCount("triangles", triangles);
+		frameStats.addCount("proxy blocks", cityLod.proxyBlocks());
+		frameStats.addCount("lod switches", cityLod.switches());
+		dropUnusedProxies();
+		frameStats.addCount("arena proxies", proxyArena.meshCount());
+		frameStats.addCount("arena vertices", proxyArena.usedVertices());
+		frameStats.addCount("arena peak vertices", proxyArena.peakVertices());
+		frameStats.addCount("arena fragmentation", proxyArena.fragmentation());
+		frameStats.addCount("arena allocations", proxyArena.allocations());
+		frameStats.addCount("arena full", proxyArena.failedAllocations());
+		frameStats.addTime("arena allocation", proxyArena.allocationMilliseconds());
+		proxyArena.resetStats();
+
+		// INDIRECT - floors of buildings and ground tiles inside the frustum, one multi-draw per texture
+		if (useIndirect) {
+			Frustum frustum = extractFrustum(projection * view);
+			addGroundTiles(frustum, crossingPositions, MATERIAL_CROSSING, ground.indexCount);
+			addGroundTiles(frustum, streetPositions, MATERIAL_STREET, ground.indexCount);
+			addGroundTiles(frustum, street2Positions, MATERIAL_STREET2, ground.indexCount);
+			indirectDraws.upload();
+
+			setLighting(indirectShader, lightPos, renderPosition);
+			indirectShader.setMat4("projection", projection);
+			indirectShader.setMat4("view", view);
+			glState.activeTexture(GL_TEXTURE0);
+			glState.bindVertexArray(cube.VAO);
+			GLsizei commands = 0;
+			for (int level = 0; level < BuildingPulling::LEVELS; level++) {
+				for (int pair = 0; pair < 3; pair++) {
+					glState.bindTexture(GL_TEXTURE_2D, levelTextures[level][pair]);
+					indirectDraws.draw(MATERIAL_FLOORS + level * 3 + pair);
+					commands += indirectDraws.commandCount(MATERIAL_FLOORS + level * 3 + pair);
+				}
+			}
+			glState.bindVertexArray(ground.VAO);
+			const unsigned int groundTextures[3] = { textureCrossing, textureStreet, textureStreet2 };
+			for (int material = MATERIAL_CROSSING; material <= MATERIAL_STREET2; material++) {
+				glState.bindTexture(GL_TEXTURE_2D, groundTextures[material]);
+				indirectDraws.draw(material);
+				commands += indirectDraws.commandCount(material);
+			}
+			lightingShader.use();
+			frameStats.addCount("indirect objects", (double)indirectDraws.objectCount());
+			frameStats.addCount("indirect commands", commands);
+			frameStats.addCount("indirect bytes", (double)indirectDraws.uploadedBytes());
+		}
+		else {
+			// CROSSINGS - 2nd group of object
+			glState.bindTexture(GL_TEXTURE0, GL_TEXTURE_2D, textureCrossing);
+			glState.bindVertexArray(ground.VAO);
+			for (unsigned int i = 0; i < crossingPositions.size(); i++) {
 				glm::mat4 model;
-				model = glm::translate(model, glm::vec3(cubePositions[i].x, cubePositions[i].y, cubePositions[i].z));
-				model = glm::rotate(model, glm::radians(0.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-				lightingShader.setMat4("model", model);
-
-				// back
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, textureWall2_fb);
-				glBindVertexArray(VAO);
-				glDrawArrays(GL_TRIANGLES, 0, 6);
-
-				// front
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, textureWall2_fb);
-				glDrawArrays(GL_TRIANGLES, 6, 6);
-
-				// left
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, textureWall2_rl);
-				glDrawArrays(GL_TRIANGLES, 12, 6);
-
-				// right
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, textureWall2_rl);
-				glDrawArrays(GL_TRIANGLES, 18, 6);
-
-				// bottom
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, textureWall2_tb);
-				glDrawArrays(GL_TRIANGLES, 24, 6);
-
-				// top
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, textureWall2_tb);
-				glDrawArrays(GL_TRIANGLES, 30, 6);
+				model = glm::translate(model, crossingPositions[i]);
+				model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+				setModel(model);
+				glDrawElements(GL_TRIANGLES, ground.indexCount, GL_UNSIGNED_INT, (void*)0);
 			}
 
-			// level 3
-			else {
+			// STREETS VERTICAL - 3rd group of object
+			glState.bindTexture(GL_TEXTURE0, GL_TEXTURE_2D, textureStreet);
+			glState.bindVertexArray(ground.VAO);
+			for (unsigned int i = 0; i < streetPositions.size(); i++) {
 				glm::mat4 model;
-				model = glm::translate(model, glm::vec3(cubePositions[i].x, cubePositions[i].y, cubePositions[i].z));
-				model = glm::rotate(model, glm::radians(0.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-				lightingShader.setMat4("model", model);
-
-				// back
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, textureWall3_fb);
-				glBindVertexArray(VAO);
-				glDrawArrays(GL_TRIANGLES, 0, 6);
-
-				// front
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, textureWall3_fb);
-				glDrawArrays(GL_TRIANGLES, 6, 6);
-
-				// left
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, textureWall3_rl);
-				glDrawArrays(GL_TRIANGLES, 12, 6);
-
-				// right
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, textureWall3_rl);
-				glDrawArrays(GL_TRIANGLES, 18, 6);
-
-				// bottom
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, textureWall3_tb);
-				glDrawArrays(GL_TRIANGLES, 24, 6);
-
-				// top
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, textureWall3_tb);
-				glDrawArrays(GL_TRIANGLES, 30, 6);
+				model = glm::translate(model, streetPositions[i]);
+				model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(0.5f, 0.0f, 0.0f));
+				setModel(model);
+				glDrawElements(GL_TRIANGLES, ground.indexCount, GL_UNSIGNED_INT, (void*)0);
 			}
-		}
 
-		// CROSSINGS - 2nd group of object
-		configureAnotherVAO(&VAO2, verticesTab2, verticesSize2);
-		howInterpretVertexData(8, 3, 3, 2, 0, 3, 6);
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, textureCrossing);
-		glBindVertexArray(VAO2);
-		for (unsigned int i = 0; i < crossingPositions.size(); i++) {
-			glm::mat4 model;
-			model = glm::translate(model, crossingPositions[i]);
-			model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-			lightingShader.setMat4("model", model);
-			glDrawArrays(GL_TRIANGLES, 0, 6);
+			// STREETS HORIZONTAL - 4th group of object
+			glState.bindTexture(GL_TEXTURE0, GL_TEXTURE_2D, textureStreet2);
+			glState.bindVertexArray(ground.VAO);
+			for (unsigned int i = 0; i < street2Positions.size(); i++) {
+				glm::mat4 model;
+				model = glm::translate(model, street2Positions[i]);
+				model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(0.5f, 0.0f, 0.0f));
+				setModel(model);
+				glDrawElements(GL_TRIANGLES, ground.indexCount, GL_UNSIGNED_INT, (void*)0);
+			}
 		}
 
-		// STREETS VERTICAL - 3rd group of object
-		configureAnotherVAO(&VAO3, verticesTab2, verticesSize2);
-		howInterpretVertexData(8, 3, 3, 2, 0, 3, 6);
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, textureStreet);
-		glBindVertexArray(VAO3);
-		for (unsigned int i = 0; i < streetPositions.size(); i++) {
-			glm::mat4 model;
-			model = glm::translate(model, streetPositions[i]);
-			model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(0.5f, 0.0f, 0.0f));
-			lightingShader.setMat4("model", model);
-			glDrawArrays(GL_TRIANGLES, 0, 6);
-		}
 
-		// STREETS HORIZONTAL - 4th group of object
-		configureAnotherVAO(&VAO4, verticesTab2, verticesSize2);
-		howInterpretVertexData(8, 3, 3, 2, 0, 3, 6);
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, textureStreet2);
-		glBindVertexArray(VAO4);
-		for (unsigned int i = 0; i < street2Positions.size(); i++) {
-			glm::mat4 model;
-			model = glm::translate(model, street2Positions[i]);
-			model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(0.5f, 0.0f, 0.0f));
-			lightingShader.setMat4("model", model);
-			glDrawArrays(GL_TRIANGLES, 0, 6);
+		// OCCLUSION QUERIES - boxes of the drawn blocks against the finished depth buffer, used in the next frame
+		if (hardwareOcclusion) {
+			lampShader.use();
+			lampShader.setMat4("projection", projection);
+			lampShader.setMat4("view", view);
+			glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+			glDepthMask(GL_FALSE);
+			glState.bindVertexArray(cube.VAO);
+			const std::vector<QuadtreeNode> & blockNodes = cityQuadtree.getNodes();
+			for (unsigned int i = 0; i < drawnBlocks.size(); i++) {
+				const QuadtreeNode & block = blockNodes[drawnBlocks[i]];
+				if (!OcclusionQueries::canQueryBox(renderPosition, block.boxMin, block.boxMax))
+					continue;
+				// a bit bigger than the block, so its faces don't fight with the walls in the depth test
+				glm::mat4 boxModel;
+				boxModel = glm::translate(boxModel, (block.boxMin + block.boxMax) * 0.5f);
+				boxModel = glm::scale(boxModel, block.boxMax - block.boxMin + glm::vec3(0.02f));
+				lampShader.setMat4("model", boxModel);
+				occlusionQueries.beginQuery(drawnBlocks[i]);
+				glDrawElements(GL_TRIANGLES, cube.indexCount, GL_UNSIGNED_INT, (void*)0);
+				occlusionQueries.endQuery();
+			}
+			glDepthMask(GL_TRUE);
+			glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+			frameStats.addCount("queries", occlusionQueries.issued());
+			frameStats.addCount("culled blocks", occlusionQueries.culledBlocks());
+			frameStats.addCount("late queries", occlusionQueries.lateResults());
+			frameStats.addTime("query stall", occlusionQueries.stallMilliseconds());
 		}
 
 
@@ -819,48 +1273,91 @@ RENDER LOOP
 		model = glm::translate(model, lightPos);
 		model = glm::scale(model, glm::vec3(1.01f)); // scale cube
 		lampShader.setMat4("model", model);
-		glBindVertexArray(lightVAO);
-		glDrawArrays(GL_TRIANGLES, 0, 36);
+		glState.bindVertexArray(cube.VAO);
+		glDrawElements(GL_TRIANGLES, cube.indexCount, GL_UNSIGNED_INT, (void*)0);
 
 
 		// skybox == "sky"
-		glDepthFunc(GL_LEQUAL); // change depth function
+		glState.depthFunc(GL_LEQUAL); // change depth function
 		skyboxShader.use();
-		configureAnotherVAO(&skyboxVAO, skyboxVertices, skyboxVerticesSize);
-		howInterpretVertexData(8, 3, 3, 2, 0, 3, 6);
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture);
-		glBindVertexArray(skyboxVAO);
-		projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
+		glState.bindTexture(GL_TEXTURE0, GL_TEXTURE_CUBE_MAP, cubemapTexture);
+		glState.bindVertexArray(sky.VAO);
 		view = glm::mat4(glm::mat3(camera.GetViewMatrix())); // remove translation from the view matrix
 		skyboxShader.setMat4("view", view);
 		skyboxShader.setMat4("projection", projection);
-		skyboxShader.use();
-		glDrawArrays(GL_TRIANGLES, 0, 36);
-		glDepthFunc(GL_LESS); // rechange depth
+		glDrawElements(GL_TRIANGLES, sky.indexCount, GL_UNSIGNED_INT, (void*)0);
+		glState.depthFunc(GL_LESS); // rechange depth
+
+		// depth of the finished frame for the GPU culling of the next one
+		if (useGpuCulling && useDepthPyramid)
+			gpuCulling.buildDepthPyramid(viewProjection);
+
+		// GPU statistics of frames finished by now
+		pipelineStatistics.end();
+		if (pipelineStatistics.hasCounters()) {
+			frameStats.addCount("vertex shader", pipelineStatistics.counter(COUNTER_VERTEX_SHADER));
+			frameStats.addCount("fragment shader", pipelineStatistics.counter(COUNTER_FRAGMENT_SHADER));
+			frameStats.addCount("clipping in", pipelineStatistics.counter(COUNTER_CLIPPING_INPUT));
+			frameStats.addCount("clipping out", pipelineStatistics.counter(COUNTER_CLIPPING_OUTPUT));
+		}
+		frameStats.addTime("gpu", pipelineStatistics.gpuMilliseconds());
+		pipelineStatistics.resetStats();
 		
 
+		frameData.endFrame();
+		frameStats.addCount("frame data bytes", (double)frameData.usedBytes());
+		frameStats.addCount("frame data wasted", (double)frameData.wastedBytes());
+		frameStats.addCount("fence waits", frameData.waits());
+		frameStats.addTime("fence wait", frameData.waitMilliseconds());
+		frameData.resetStats();
+
+		// render - CPU time of issuing the frame, swap - waiting for the GPU and vsync
+		double swapStart = glfwGetTime();
+		frameStats.addTime("render", (swapStart - renderStart) * 1000.0);
+
 		// swap buffers and poll IO events(keys pressed / released, mouse moved etc.)
 		glfwSwapBuffers(window);
 		glfwPollEvents(); 
-
-		// ordnung
-		cleanVAO_VBO_EBO(&VAO, &VBO, &EBO);
-		glDeleteVertexArrays(1, &skyboxVAO);
-		glDeleteBuffers(1, &skyboxVAO);
-		glDeleteVertexArrays(1, &VAO2);
-		glDeleteVertexArrays(1, &VAO3);
-		glDeleteVertexArrays(1, &VAO4);
-		glDeleteVertexArrays(1, &lightVAO);
+		frameStats.addTime("swap", (glfwGetTime() - swapStart) * 1000.0);
+		frameStats.addCount("gl calls", (double)glState.madeTotal());
+		frameStats.addCount("gl filtered", (double)glState.filteredTotal());
+		glState.resetCounters();
+		frameStats.endFrame(glfwGetTime());
+		frameNumber++;
 	}
 
 	// delete
+	occlusionQueries.release();
+	releaseMesh(cube);
+	releaseMesh(ground);
+	releaseMesh(sky);
+	proxyArena.release();
+	glDeleteTextures(1, &lodAtlas);
+	impostorAtlas.release();
+	buildingPulling.release();
+	indirectDraws.release();
+	gpuCulling.release();
+	glDeleteVertexArrays(1, &impostorVAO);
+	glDeleteBuffers(1, &impostorQuadVBO);
+	frameData.release();
+	pipelineStatistics.release();
 	glfwTerminate();
 		
 	return 0;
 }
 
 
+// true only in the first call after the key went down (for switches)
+bool isKeyPressedOnce(GLFWwindow *window, int key)
+{
+	static bool wasPressed[GLFW_KEY_LAST + 1] = { false };
+	bool pressed = glfwGetKey(window, key) == GLFW_PRESS;
+	bool once = pressed && !wasPressed[key];
+	wasPressed[key] = pressed;
+	return once;
+}
+
+
 //  process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
 void processInput(GLFWwindow *window)
 {
@@ -877,6 +1374,49 @@ void processInput(GLFWwindow *window)
 		camera.ProcessKeyboard(RIGHT, deltaTime);
 	if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS)
 		camera.ProcessKeyboard(UPWARD, deltaTime);
+
+	// switches of the renderer
+	if (isKeyPressedOnce(window, GLFW_KEY_C))
+		frustumCulling = !frustumCulling;
+	if (isKeyPressedOnce(window, GLFW_KEY_H))
+		horizonCullingOn = !horizonCullingOn;
+	if (isKeyPressedOnce(window, GLFW_KEY_G))
+		hardwareOcclusion = !hardwareOcclusion;
+	if (isKeyPressedOnce(window, GLFW_KEY_V))
+		usePvs = !usePvs;
+	if (isKeyPressedOnce(window, GLFW_KEY_L))
+		useLod = !useLod;
+	if (isKeyPressedOnce(window, GLFW_KEY_I))
+		useImpostors = !useImpostors;
+	if (isKeyPressedOnce(window, GLFW_KEY_M))
+		useIndirect = !useIndirect && glMultiDrawElementsIndirect != NULL;
+	if (isKeyPressedOnce(window, GLFW_KEY_B))
+		useVertexPulling = !useVertexPulling && BuildingPulling::canPull(camera.sizeOfCity);
+	if (isKeyPressedOnce(window, GLFW_KEY_U)) {
+		useGpuCulling = !useGpuCulling && gpuCulling.getVAO() != 0;
+		gpuCulling.dropDepthPyramid();
+	}
+	if (isKeyPressedOnce(window, GLFW_KEY_Z)) {
+		useDepthPyramid = !useDepthPyramid;
+		gpuCulling.dropDepthPyramid();
+	}
+	if (isKeyPressedOnce(window, GLFW_KEY_O))
+		softwareOcclusion = !softwareOcclusion;
+	if (isKeyPressedOnce(window, GLFW_KEY_F))
+		frontToBack = !frontToBack;
+	if (isKeyPressedOnce(window, GLFW_KEY_E))
+		depthPrepass = !depthPrepass;
+	if (isKeyPressedOnce(window, GLFW_KEY_N))
+		faceBuckets = !faceBuckets;
+	if (isKeyPressedOnce(window, GLFW_KEY_K)) {
+		backFaceCulling = !backFaceCulling;
+		if (backFaceCulling)
+			glEnable(GL_CULL_FACE);
+		else
+			glDisable(GL_CULL_FACE);
+	}
+	if (isKeyPressedOnce(window, GLFW_KEY_P))
+		occlusionCulling.dumpDepth(OcclusionCulling::dumpPath().c_str());
 }
 
 